@@ -4,6 +4,12 @@
 #include <string>
 #include <sstream>
 #include <array>
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <numeric>
+#include <thread>
 
 std::string readFile(const std::string& filename) {
     std::ifstream file(filename);
@@ -11,171 +17,437 @@ std::string readFile(const std::string& filename) {
                        std::istreambuf_iterator<char>());
 }
 
-using Grid = std::vector<std::vector<char>>;
+using Grid = std::vector<std::string>;
 
-const std::array<char, 4> XMAS = {'X', 'M', 'A', 'S'};
-const std::array<char, 4> SAMX = {'S', 'A', 'M', 'X'};
+Grid read_grid(const std::string& input) {
+    Grid grid;
+    std::stringstream ss(input);
+    std::string line;
 
-bool array_has_xmas(const std::array<char, 4>& arr) {
-    return arr == SAMX || arr == XMAS;
+    while (std::getline(ss, line)) {
+        if (!line.empty()) {
+            grid.push_back(line);
+        }
+    }
+    return grid;
 }
 
-std::array<char, 4> get_first_column(const std::vector<std::vector<char>>& block, int col) {
-    std::array<char, 4> result;
-    for (int i = 0; i < 4; i++) {
-        result[i] = block[i][col];
+const std::array<char, 4> XMAS = {'X', 'M', 'A', 'S'};
+
+const int MIN_STRIPE_ROWS = 64;
+
+// Splits rows [0, rows) into horizontal stripes, one per hardware thread, and
+// sums count_rows(row_begin, row_end) over them. Every match is attributed to
+// its starting row, so a stripe reads the 3-row halo below it but only counts
+// matches that start inside it.
+template <typename CountRows>
+long long sum_over_stripes(int rows, CountRows count_rows) {
+    int threads = std::max(1u, std::thread::hardware_concurrency());
+    int stripes = std::clamp(rows / MIN_STRIPE_ROWS, 1, threads);
+    if (stripes == 1) {
+        return count_rows(0, rows);
+    }
+
+    std::vector<long long> partial(stripes, 0);
+    std::vector<std::thread> workers;
+    for (int s = 0; s < stripes; s++) {
+        int row_begin = static_cast<long long>(rows) * s / stripes;
+        int row_end = static_cast<long long>(rows) * (s + 1) / stripes;
+        workers.emplace_back([&, s, row_begin, row_end] {
+            partial[s] = count_rows(row_begin, row_end);
+        });
     }
-    return result;
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    return std::accumulate(partial.begin(), partial.end(), 0LL);
 }
 
-std::array<char, 4> get_first_row(const std::vector<std::vector<char>>& block, int row) {
-    std::array<char, 4> result;
-    for (int i = 0; i < 4; i++) {
-        result[i] = block[row][i];
+// One bit plane per letter of XMAS, each row packed into 64-bit words so a
+// single AND tests 64 starting cells at once.
+struct LetterBoard {
+    int rows = 0;
+    int cols = 0;
+    int words = 0;
+    std::array<std::vector<uint64_t>, 4> planes;
+
+    uint64_t shifted(int letter, int row, int word, int shift) const {
+        const uint64_t* bits = planes[letter].data() + static_cast<size_t>(row) * words;
+        uint64_t result = bits[word] >> shift;
+        if (shift > 0 && word + 1 < words) {
+            result |= bits[word + 1] << (64 - shift);
+        }
+        return result;
+    }
+};
+
+LetterBoard build_letter_board(const Grid& lines) {
+    LetterBoard board;
+    board.rows = lines.size();
+    board.cols = lines.empty() ? 0 : lines[0].size();
+    board.words = (board.cols + 63) / 64;
+    for (auto& plane : board.planes) {
+        plane.assign(static_cast<size_t>(board.rows) * board.words, 0);
+    }
+
+    for (int i = 0; i < board.rows; i++) {
+        for (int j = 0; j < static_cast<int>(lines[i].size()) && j < board.cols; j++) {
+            for (int letter = 0; letter < 4; letter++) {
+                if (lines[i][j] == XMAS[letter]) {
+                    board.planes[letter][static_cast<size_t>(i) * board.words + j / 64] |= uint64_t{1} << (j % 64);
+                }
+            }
+        }
     }
-    return result;
+
+    return board;
 }
 
-std::array<char, 4> get_diagonal(const std::vector<std::vector<char>>& block) {
-    std::array<char, 4> result;
-    for (int i = 0; i < 4; i++) {
-        result[i] = block[i][i];
+// Counts occurrences of `word` (as letter indices) starting in rows
+// [row_begin, row_end) along the line (dr, dc). Bits past the last column are
+// zero, so anything shifted in from beyond the grid never matches.
+long long count_direction(const LetterBoard& board, const std::array<int, 4>& word,
+                          int dr, int dc, int row_begin, int row_end) {
+    long long count = 0;
+    int last_row = std::min(row_end, board.rows - 3 * dr);
+
+    for (int i = row_begin; i < last_row; i++) {
+        for (int w = 0; w < board.words; w++) {
+            uint64_t hits = ~uint64_t{0};
+            for (int k = 0; k < 4 && hits; k++) {
+                int shift = dc >= 0 ? k * dc : 3 - k;
+                hits &= board.shifted(word[k], i + k * dr, w, shift);
+            }
+            count += std::popcount(hits);
+        }
     }
-    return result;
+
+    return count;
 }
 
-std::array<char, 4> get_anti_diagonal(const std::vector<std::vector<char>>& block) {
-    std::array<char, 4> result;
-    for (int i = 0; i < 4; i++) {
-        result[i] = block[i][3-i];
+long long count_xmas(const LetterBoard& board, int row_begin, int row_end) {
+    const std::array<int, 4> forward = {0, 1, 2, 3};
+    const std::array<int, 4> backward = {3, 2, 1, 0};
+    const std::array<std::array<int, 2>, 4> directions = {{
+        {0, 1}, {1, 0}, {1, 1}, {1, -1}
+    }};
+
+    long long count = 0;
+    for (const auto& [dr, dc] : directions) {
+        count += count_direction(board, forward, dr, dc, row_begin, row_end);
+        count += count_direction(board, backward, dr, dc, row_begin, row_end);
     }
-    return result;
+    return count;
 }
 
-int search_xmas_in_block(const std::vector<std::vector<char>>& block) {
-    int count = 0;
-    if (array_has_xmas(get_first_column(block, 0))) {
-        count++;
+long long part_1(const std::string& input) {
+    LetterBoard board = build_letter_board(read_grid(input));
+    return sum_over_stripes(board.rows, [&](int row_begin, int row_end) {
+        return count_xmas(board, row_begin, row_end);
+    });
+}
+
+// A dictionary of words (matched along rows, columns and both diagonals, in
+// both reading directions) and 2D stencils ('.' is a wildcard cell).
+struct PatternSet {
+    std::vector<std::string> words;
+    std::vector<std::vector<std::string>> stencils;
+};
+
+struct PatternCounts {
+    std::vector<long long> words;
+    std::vector<long long> stencils;
+};
+
+struct StencilCell {
+    int dr;
+    int dc;
+    char letter;
+};
+
+// Words are compiled into one Aho-Corasick automaton (each word inserted
+// forwards and reversed) so every grid line is streamed through it once.
+// Stencils are anchored on their first fixed cell and bucketed by its
+// letter, so each grid cell only tries the stencils that can start there.
+struct CompiledPatterns {
+    std::array<int, 256> alphabet{};
+    int alphabet_size = 1;
+    std::vector<int> transitions;
+    std::vector<std::vector<int>> outputs;
+    size_t word_count = 0;
+
+    std::array<std::vector<int>, 256> stencils_by_anchor;
+    std::vector<std::vector<StencilCell>> stencil_cells;
+
+    int next(int state, char c) const {
+        return transitions[state * alphabet_size + alphabet[static_cast<unsigned char>(c)]];
     }
-    if (array_has_xmas(get_first_row(block, 0))) {
-        count++;
+};
+
+CompiledPatterns compile_patterns(const PatternSet& patterns) {
+    CompiledPatterns compiled;
+    compiled.word_count = patterns.words.size();
+
+    for (const auto& word : patterns.words) {
+        for (char c : word) {
+            int& symbol = compiled.alphabet[static_cast<unsigned char>(c)];
+            if (symbol == 0) {
+                symbol = compiled.alphabet_size++;
+            }
+        }
     }
-    if (array_has_xmas(get_diagonal(block))) {
-        count++;
+
+    const int k = compiled.alphabet_size;
+    std::vector<std::vector<int>> trie(1, std::vector<int>(k, -1));
+    compiled.outputs.assign(1, {});
+
+    auto insert = [&](const std::string& word, int id) {
+        int state = 0;
+        for (char c : word) {
+            int symbol = compiled.alphabet[static_cast<unsigned char>(c)];
+            if (trie[state][symbol] == -1) {
+                trie[state][symbol] = trie.size();
+                trie.emplace_back(k, -1);
+                compiled.outputs.emplace_back();
+            }
+            state = trie[state][symbol];
+        }
+        compiled.outputs[state].push_back(id);
+    };
+
+    for (size_t id = 0; id < patterns.words.size(); id++) {
+        const std::string& word = patterns.words[id];
+        if (word.empty()) {
+            continue;
+        }
+        insert(word, id);
+        insert(std::string(word.rbegin(), word.rend()), id);
     }
-    if (array_has_xmas(get_anti_diagonal(block))) {
-        count++;
+
+    // Breadth-first over the trie to turn it into a full DFA, merging each
+    // state's outputs with those of its failure state.
+    compiled.transitions.assign(trie.size() * k, 0);
+    std::vector<int> fail(trie.size(), 0);
+    std::vector<int> queue;
+
+    for (int symbol = 1; symbol < k; symbol++) {
+        int child = trie[0][symbol];
+        if (child != -1) {
+            compiled.transitions[symbol] = child;
+            queue.push_back(child);
+        }
     }
-    
-    return count;
-}
 
-int part_1(const std::string& input) {
-    std::vector<std::vector<char>> char_arr;
-    std::stringstream ss(input);
-    std::string line;
-    
-    while (std::getline(ss, line)) {
-        std::vector<char> row(line.begin(), line.end());
-        char_arr.push_back(row);
-    }
-    
-    int original_rows = char_arr.size();
-    int original_cols = char_arr[0].size();
-    
-    Grid padded_grid(original_rows + 3, std::vector<char>(original_cols + 3, '.'));
-    
-    for (int i = 0; i < original_rows; i++) {
-        for (int j = 0; j < original_cols; j++) {
-            padded_grid[i][j] = char_arr[i][j];
-        }
-    }
-    
-    int total_xmas = 0;
-    
-    for (int i = 0; i <= padded_grid.size() - 4; i++) {
-        for (int j = 0; j <= padded_grid[0].size() - 4; j++) {
-            std::vector<std::vector<char>> block(4, std::vector<char>(4));
-            for (int x = 0; x < 4; x++) {
-                for (int y = 0; y < 4; y++) {
-                    block[x][y] = padded_grid[i + x][j + y];
+    for (size_t head = 0; head < queue.size(); head++) {
+        int state = queue[head];
+        const auto& inherited = compiled.outputs[fail[state]];
+        compiled.outputs[state].insert(compiled.outputs[state].end(), inherited.begin(), inherited.end());
+
+        for (int symbol = 1; symbol < k; symbol++) {
+            int child = trie[state][symbol];
+            int fallback = compiled.transitions[fail[state] * k + symbol];
+            if (child == -1) {
+                compiled.transitions[state * k + symbol] = fallback;
+            } else {
+                compiled.transitions[state * k + symbol] = child;
+                fail[child] = fallback;
+                queue.push_back(child);
+            }
+        }
+    }
+
+    for (size_t id = 0; id < patterns.stencils.size(); id++) {
+        std::vector<StencilCell> cells;
+        const auto& stencil = patterns.stencils[id];
+        for (int i = 0; i < static_cast<int>(stencil.size()); i++) {
+            for (int j = 0; j < static_cast<int>(stencil[i].size()); j++) {
+                if (stencil[i][j] != '.') {
+                    cells.push_back({i, j, stencil[i][j]});
                 }
             }
-            total_xmas += search_xmas_in_block(block);
         }
+        if (cells.empty()) {
+            compiled.stencil_cells.push_back(cells);
+            continue;
+        }
+
+        StencilCell anchor = cells[0];
+        for (auto& cell : cells) {
+            cell.dr -= anchor.dr;
+            cell.dc -= anchor.dc;
+        }
+        compiled.stencils_by_anchor[static_cast<unsigned char>(anchor.letter)].push_back(id);
+        compiled.stencil_cells.push_back(cells);
     }
-    
-    return total_xmas;
+
+    return compiled;
 }
 
-std::array<char, 5> get_cross_pattern(const std::vector<std::vector<char>>& block) {
-    std::array<char, 5> result;
-    result[0] = block[0][0];
-    result[1] = block[0][2];
-    result[2] = block[1][1];
-    result[3] = block[2][0];
-    result[4] = block[2][2];
-    return result;
+// Counts stencil matches anchored in rows [row_begin, row_end). Stencils
+// reach below their anchor row, so callers striping the grid only need the
+// rows after row_end to be readable, never a second count of them.
+void count_stencils(const CompiledPatterns& compiled, const Grid& grid,
+                    int row_begin, int row_end, std::vector<long long>& counts) {
+    const int rows = grid.size();
+    const int cols = rows == 0 ? 0 : grid[0].size();
+
+    for (int i = row_begin; i < row_end; i++) {
+        for (int j = 0; j < cols; j++) {
+            for (int id : compiled.stencils_by_anchor[static_cast<unsigned char>(grid[i][j])]) {
+                bool matched = true;
+                for (const auto& cell : compiled.stencil_cells[id]) {
+                    int r = i + cell.dr;
+                    int c = j + cell.dc;
+                    if (r >= rows || c < 0 || c >= cols || grid[r][c] != cell.letter) {
+                        matched = false;
+                        break;
+                    }
+                }
+                if (matched) {
+                    counts[id]++;
+                }
+            }
+        }
+    }
 }
 
-bool search_cross_mas(const std::vector<std::vector<char>>& block) {
-    std::array<char, 5> letters = get_cross_pattern(block);
-    
-    const std::array<std::array<char, 5>, 4> rotations = {{
-        {'M', 'M', 'A', 'S', 'S'},
-        {'S', 'S', 'A', 'M', 'M'},
-        {'S', 'M', 'A', 'S', 'M'},
-        {'M', 'S', 'A', 'M', 'S'}
-    }};
-    
-    for (const auto& rotation : rotations) {
-        if (letters == rotation) {
-            return true;
+PatternCounts search_grid(const CompiledPatterns& compiled, const Grid& grid) {
+    PatternCounts counts;
+    counts.words.assign(compiled.word_count, 0);
+    counts.stencils.assign(compiled.stencil_cells.size(), 0);
+
+    const int rows = grid.size();
+    const int cols = rows == 0 ? 0 : grid[0].size();
+
+    auto stream_line = [&](int r, int c, int dr, int dc) {
+        int state = 0;
+        for (; r >= 0 && r < rows && c >= 0 && c < cols; r += dr, c += dc) {
+            state = compiled.next(state, grid[r][c]);
+            for (int id : compiled.outputs[state]) {
+                counts.words[id]++;
+            }
+        }
+    };
+
+    if (compiled.word_count > 0) {
+        for (int i = 0; i < rows; i++) {
+            stream_line(i, 0, 0, 1);
+            stream_line(i, 0, 1, 1);
+            stream_line(i, cols - 1, 1, -1);
+        }
+        for (int j = 0; j < cols; j++) {
+            stream_line(0, j, 1, 0);
+            if (j > 0) {
+                stream_line(0, j, 1, 1);
+            }
+            if (j < cols - 1) {
+                stream_line(0, j, 1, -1);
+            }
         }
     }
-    return false;
+
+    count_stencils(compiled, grid, 0, rows, counts.stencils);
+
+    return counts;
 }
 
-int part_2(const std::string& input) {
-    std::vector<std::vector<char>> char_arr;
-    std::stringstream ss(input);
-    std::string line;
-    
-    while (std::getline(ss, line)) {
-        std::vector<char> row(line.begin(), line.end());
-        char_arr.push_back(row);
-    }
-    
-    int original_rows = char_arr.size();
-    int original_cols = char_arr[0].size();
-    
-    Grid padded_grid(original_rows + 2, std::vector<char>(original_cols + 2, '.'));
-    
-    for (int i = 0; i < original_rows; i++) {
-        for (int j = 0; j < original_cols; j++) {
-            padded_grid[i][j] = char_arr[i][j];
-        }
-    }
-    
-    int total_cross_mas = 0;
-    
-    for (int i = 0; i <= padded_grid.size() - 3; i++) {
-        for (int j = 0; j <= padded_grid[0].size() - 3; j++) {
-            std::vector<std::vector<char>> block(3, std::vector<char>(3));
-            for (int x = 0; x < 3; x++) {
-                for (int y = 0; y < 3; y++) {
-                    block[x][y] = padded_grid[i + x][j + y];
-                }
+// 32 grid cells per register. GCC vector extensions lower to whatever SIMD
+// width the target offers, so no -m flags are needed to build.
+typedef signed char Lanes __attribute__((vector_size(32)));
+const int LANES = sizeof(Lanes);
+
+void load_lanes(Lanes& v, const char* p) {
+    std::memcpy(&v, p, sizeof(v));
+}
+
+bool is_cross_mas(const char* top, const char* mid, const char* bot, int j) {
+    bool diagonal = (top[j] == 'M' && bot[j + 2] == 'S') || (top[j] == 'S' && bot[j + 2] == 'M');
+    bool anti_diagonal = (top[j + 2] == 'M' && bot[j] == 'S') || (top[j + 2] == 'S' && bot[j] == 'M');
+    return mid[j + 1] == 'A' && diagonal && anti_diagonal;
+}
+
+// Counts X-MAS windows whose top row lies in [row_begin, row_end). Each step
+// loads the three rows of 32 consecutive windows and tests the A centre and
+// both M/S diagonals lane-wise; lane results are accumulated as bytes and
+// flushed before they can overflow.
+long long count_cross_mas(const Grid& grid, int row_begin, int row_end) {
+    const int rows = grid.size();
+    const int cols = rows == 0 ? 0 : grid[0].size();
+    const int last_row = std::min(row_end, rows - 2);
+    long long total_cross_mas = 0;
+
+    for (int i = row_begin; i < last_row; i++) {
+        const char* top = grid[i].data();
+        const char* mid = grid[i + 1].data();
+        const char* bot = grid[i + 2].data();
+
+        Lanes hits = {};
+        int pending = 0;
+        auto flush = [&] {
+            for (int lane = 0; lane < LANES; lane++) {
+                total_cross_mas += static_cast<unsigned char>(hits[lane]);
             }
-            if (search_cross_mas(block)) {
+            hits = Lanes{};
+            pending = 0;
+        };
+
+        int j = 0;
+        for (; j + LANES + 2 <= cols; j += LANES) {
+            Lanes tl, tr, centre, bl, br;
+            load_lanes(tl, top + j);
+            load_lanes(tr, top + j + 2);
+            load_lanes(centre, mid + j + 1);
+            load_lanes(bl, bot + j);
+            load_lanes(br, bot + j + 2);
+
+            Lanes diagonal = ((tl == 'M') & (br == 'S')) | ((tl == 'S') & (br == 'M'));
+            Lanes anti_diagonal = ((tr == 'M') & (bl == 'S')) | ((tr == 'S') & (bl == 'M'));
+            hits -= (centre == 'A') & diagonal & anti_diagonal;
+
+            if (++pending == 255) {
+                flush();
+            }
+        }
+        flush();
+
+        for (; j + 2 < cols; j++) {
+            if (is_cross_mas(top, mid, bot, j)) {
                 total_cross_mas++;
             }
         }
     }
-    
+
     return total_cross_mas;
 }
 
+long long part_2(const std::string& input) {
+    Grid grid = read_grid(input);
+
+    return sum_over_stripes(grid.size(), [&](int row_begin, int row_end) {
+        return count_cross_mas(grid, row_begin, row_end);
+    });
+}
+
+#ifdef CHECK_PATTERN_ENGINE
+// Debug builds only (-DCHECK_PATTERN_ENGINE): runs the general pattern engine
+// over the same grid as an independent check of the bitboard and SIMD
+// kernels, using the word for part_1 and the four X-MAS rotations for part_2.
+const PatternSet XMAS_PATTERNS = {{"XMAS"}, {
+    {"M.M", ".A.", "S.S"},
+    {"S.S", ".A.", "M.M"},
+    {"S.M", ".A.", "S.M"},
+    {"M.S", ".A.", "M.S"}
+}};
+
+bool engine_agrees(const std::string& input) {
+    static const CompiledPatterns compiled = compile_patterns(XMAS_PATTERNS);
+    PatternCounts counts = search_grid(compiled, read_grid(input));
+    long long cross_mas = std::accumulate(counts.stencils.begin(), counts.stencils.end(), 0LL);
+    return counts.words[0] == part_1(input) && cross_mas == part_2(input);
+}
+#endif
+
 int main() {
     std::string test_input = readFile("test_input.txt");
     std::string input = readFile("input.txt");
@@ -185,5 +457,12 @@ int main() {
     std::cout << "part_2_test: " << part_2(test_input) << std::endl;
     std::cout << "part_2:      " << part_2(input) << std::endl;
 
+#ifdef CHECK_PATTERN_ENGINE
+    if (!engine_agrees(test_input) || !engine_agrees(input)) {
+        std::cerr << "pattern engine disagrees with part_1 or part_2" << std::endl;
+        return 1;
+    }
+#endif
+
     return 0;
-}
\ No newline at end of file
+}
@@ -6,7 +6,9 @@
 #include <array>
 #include <algorithm>
 #include <utility>
-#include <set>
+#include <bit>
+#include <cstdint>
+#include <optional>
 
 std::string readFile(const std::string& filename) {
     std::ifstream file(filename);
@@ -39,38 +41,247 @@ std::vector<int> parse_numbers(const std::string& s, char delim = ',') {
     return numbers;
 }
 
-int solve(const std::string& input, int part) {
-    auto [p1, p2] = parse_input(input);
-    std::set<std::pair<int, int>> compare_list;
-    
-    for (const auto& line : split(p1, '\n')) {
-        auto nums = parse_numbers(line, '|');
-        compare_list.insert({nums[0], nums[1]});
+// Rules compiled once and reused for any number of update batches. Page
+// numbers are interned to dense ids; successors[a] has bit b set when page a
+// must be printed before page b, and predecessors[b] is the transpose.
+struct RuleIndex {
+    std::vector<int> id_of_page;
+    std::vector<int> pages;
+    size_t words = 0;
+    std::vector<uint64_t> successors;
+    std::vector<uint64_t> predecessors;
+
+    int id(int page) const {
+        return page >= 0 && page < static_cast<int>(id_of_page.size()) ? id_of_page[page] : -1;
     }
-    
-    auto is_less_than = [&compare_list](int a, int b) {
-        if (compare_list.count({a, b})) return true;
-        if (compare_list.count({b, a})) return false;
+
+    bool precedes(int a, int b) const {
+        return (successors[a * words + b / 64] >> (b % 64)) & 1;
+    }
+
+    bool is_less_than(int a, int b) const {
+        int ia = id(a);
+        int ib = id(b);
+        if (ia >= 0 && ib >= 0) {
+            if (precedes(ia, ib)) return true;
+            if (precedes(ib, ia)) return false;
+        }
         return a < b;
+    }
+};
+
+void build_bitsets(RuleIndex& index, const std::vector<std::pair<int, int>>& rules) {
+    index.words = (index.pages.size() + 63) / 64;
+    index.successors.assign(index.pages.size() * index.words, 0);
+    index.predecessors.assign(index.pages.size() * index.words, 0);
+
+    for (const auto& [a, b] : rules) {
+        index.successors[a * index.words + b / 64] |= uint64_t{1} << (b % 64);
+        index.predecessors[b * index.words + a / 64] |= uint64_t{1} << (a % 64);
+    }
+}
+
+RuleIndex compile_rules(const std::string& rules) {
+    RuleIndex index;
+    std::vector<std::pair<int, int>> rule_ids;
+
+    auto intern = [&index](int page) {
+        if (page >= static_cast<int>(index.id_of_page.size())) {
+            index.id_of_page.resize(page + 1, -1);
+        }
+        if (index.id_of_page[page] == -1) {
+            index.id_of_page[page] = index.pages.size();
+            index.pages.push_back(page);
+        }
+        return index.id_of_page[page];
+    };
+
+    for (const auto& line : split(rules, '\n')) {
+        auto nums = parse_numbers(line, '|');
+        rule_ids.push_back({intern(nums[0]), intern(nums[1])});
+    }
+
+    build_bitsets(index, rule_ids);
+    return index;
+}
+
+const uint64_t RULE_INDEX_MAGIC = 0x3158444e49454c52; // "RLEINDX1"
+const uint64_t MAX_CACHED_PAGE = 1 << 20;
+
+// 64-bit FNV-1a, so the cache key stays stable across builds and libraries.
+uint64_t fnv1a(const std::string& text) {
+    uint64_t hash = 0xcbf29ce484222325;
+    for (unsigned char c : text) {
+        hash = (hash ^ c) * 0x100000001b3;
+    }
+    return hash;
+}
+
+// The cache stores a hash of the rule text it was compiled from, the interned
+// pages and the successor rows; predecessors are rebuilt on load.
+void save_rule_index(const RuleIndex& index, const std::string& rules, const std::string& filename) {
+    std::ofstream file(filename, std::ios::binary);
+    auto write = [&file](uint64_t value) {
+        file.write(reinterpret_cast<const char*>(&value), sizeof(value));
     };
+
+    write(RULE_INDEX_MAGIC);
+    write(fnv1a(rules));
+    write(index.pages.size());
+    for (int page : index.pages) {
+        write(page);
+    }
+    for (uint64_t word : index.successors) {
+        write(word);
+    }
+}
+
+// Anything that does not match the rules exactly - a different hash, a page
+// count the rule text could not produce, a repeated or out-of-range page, a
+// successor bit past the last page, or a short or overlong file - is treated
+// as a cache miss.
+std::optional<RuleIndex> load_rule_index(const std::string& rules, const std::string& filename) {
+    std::ifstream file(filename, std::ios::binary);
+    auto read = [&file]() {
+        uint64_t value = 0;
+        file.read(reinterpret_cast<char*>(&value), sizeof(value));
+        return value;
+    };
+
+    if (!file || read() != RULE_INDEX_MAGIC || read() != fnv1a(rules)) {
+        return std::nullopt;
+    }
+
+    // Every interned page appears in the rule text, so its length bounds the count.
+    uint64_t count = read();
+    if (!file || count > rules.size()) {
+        return std::nullopt;
+    }
+
+    RuleIndex index;
+    index.pages.resize(count);
+    for (size_t i = 0; i < index.pages.size(); i++) {
+        uint64_t page = read();
+        if (!file || page > MAX_CACHED_PAGE) {
+            return std::nullopt;
+        }
+        if (page >= index.id_of_page.size()) {
+            index.id_of_page.resize(page + 1, -1);
+        }
+        if (index.id_of_page[page] != -1) {
+            return std::nullopt;
+        }
+        index.pages[i] = page;
+        index.id_of_page[page] = i;
+    }
+
+    std::vector<std::pair<int, int>> rule_ids;
+    size_t words = (index.pages.size() + 63) / 64;
+    for (size_t a = 0; a < index.pages.size(); a++) {
+        for (size_t w = 0; w < words; w++) {
+            for (uint64_t bits = read(); bits; bits &= bits - 1) {
+                size_t b = w * 64 + std::countr_zero(bits);
+                if (b >= index.pages.size()) {
+                    return std::nullopt;
+                }
+                rule_ids.push_back({a, b});
+            }
+        }
+    }
+    if (!file || file.peek() != std::ifstream::traits_type::eof()) {
+        return std::nullopt;
+    }
+
+    build_bitsets(index, rule_ids);
+    return index;
+}
+
+RuleIndex cached_rule_index(const std::string& rules, const std::string& filename) {
+    if (auto index = load_rule_index(rules, filename)) {
+        return *index;
+    }
+    RuleIndex index = compile_rules(rules);
+    save_rule_index(index, rules, filename);
+    return index;
+}
+
+// An update is correctly ordered exactly when it is already sorted under the
+// rules, which only takes one comparison per adjacent pair.
+bool is_ordered(const RuleIndex& index, const std::vector<int>& update_list) {
+    return std::is_sorted(update_list.begin(), update_list.end(),
+        [&index](int x, int y) {
+            return index.is_less_than(x, y);
+        });
+}
+
+// Middle page of the update once reordered. When the rules cover every pair
+// in the update, a page's position in the topological order is the number of
+// its required predecessors among the update's pages, so no sort is needed.
+// Those ranks are only trusted when they are exactly 0..k-1; otherwise some
+// pair is uncovered and the full comparator decides via nth_element.
+// `pages` is a zeroed scratch bitset of index.words words, left zeroed.
+int ordered_middle(const RuleIndex& index, const std::vector<int>& update_list, std::vector<uint64_t>& pages) {
+    const size_t middle = update_list.size() / 2;
+    for (int page : update_list) {
+        int id = index.id(page);
+        if (id >= 0) {
+            pages[id / 64] |= uint64_t{1} << (id % 64);
+        }
+    }
+
+    int result = -1;
+    bool covered = true;
+    std::vector<bool> rank_taken(update_list.size(), false);
+    for (int page : update_list) {
+        int id = index.id(page);
+        size_t rank = 0;
+        for (size_t w = 0; id >= 0 && w < index.words; w++) {
+            rank += std::popcount(index.predecessors[id * index.words + w] & pages[w]);
+        }
+        if (rank >= update_list.size() || rank_taken[rank]) {
+            covered = false;
+            break;
+        }
+        rank_taken[rank] = true;
+        if (rank == middle) {
+            result = page;
+        }
+    }
+    std::fill(pages.begin(), pages.end(), 0);
+
+    if (covered) {
+        return result;
+    }
+
+    std::vector<int> reordered = update_list;
+    std::nth_element(reordered.begin(), reordered.begin() + middle, reordered.end(),
+        [&index](int x, int y) {
+            return index.is_less_than(x, y);
+        });
+    return reordered[middle];
+}
+
+// Scores one batch of updates, one per line, against an already compiled
+// rule index; only the updates themselves are parsed here.
+int score_updates(const RuleIndex& index, std::istream& updates, int part) {
+    std::vector<uint64_t> pages(index.words, 0);
+    std::string update_list_str;
     
     int total = 0;
-    for (const auto& update_list_str : split(p2, '\n')) {
+    while (std::getline(updates, update_list_str)) {
+        if (update_list_str.empty()) {
+            continue;
+        }
         std::vector<int> update_list = parse_numbers(update_list_str);
-        std::vector<int> sorted_list = update_list;
-        
-        std::sort(sorted_list.begin(), sorted_list.end(), 
-            [&is_less_than](int x, int y) {
-                return is_less_than(x, y);
-            });
+        bool ordered = is_ordered(index, update_list);
         
         if (part == 1) {
-            if (update_list == sorted_list) {
+            if (ordered) {
                 total += update_list[update_list.size() / 2];
             }
         } else {
-            if (update_list != sorted_list) {
-                total += sorted_list[sorted_list.size() / 2];
+            if (!ordered) {
+                total += ordered_middle(index, update_list, pages);
             }
         }
     }
@@ -78,22 +289,39 @@ int solve(const std::string& input, int part) {
     return total;
 }
 
-int part_1(const std::string& input) {
-    return solve(input, 1);
+// A puzzle input with its rule block compiled once (or loaded from the
+// cache file next to the input), shared by both parts.
+struct Puzzle {
+    RuleIndex index;
+    std::string updates;
+};
+
+Puzzle load_puzzle(const std::string& input, const std::string& cache_file) {
+    auto [rules, updates] = parse_input(input);
+    return {cached_rule_index(rules, cache_file), updates};
 }
 
-int part_2(const std::string& input) {
-    return solve(input, 2);
+int solve(const Puzzle& puzzle, int part) {
+    std::istringstream updates(puzzle.updates);
+    return score_updates(puzzle.index, updates, part);
+}
+
+int part_1(const Puzzle& puzzle) {
+    return solve(puzzle, 1);
+}
+
+int part_2(const Puzzle& puzzle) {
+    return solve(puzzle, 2);
 }
 
 int main() {
-    std::string test_input = readFile("test_input.txt");
-    std::string input = readFile("input.txt");
+    Puzzle test_puzzle = load_puzzle(readFile("test_input.txt"), "test_input.rules.bin");
+    Puzzle puzzle = load_puzzle(readFile("input.txt"), "input.rules.bin");
 
-    std::cout << "part_1_test: " << part_1(test_input) << std::endl;
-    std::cout << "part_1:      " << part_1(input) << std::endl;
-    std::cout << "part_2_test: " << part_2(test_input) << std::endl;
-    std::cout << "part_2:      " << part_2(input) << std::endl;
+    std::cout << "part_1_test: " << part_1(test_puzzle) << std::endl;
+    std::cout << "part_1:      " << part_1(puzzle) << std::endl;
+    std::cout << "part_2_test: " << part_2(test_puzzle) << std::endl;
+    std::cout << "part_2:      " << part_2(puzzle) << std::endl;
 
     return 0;
-}
\ No newline at end of file
+}
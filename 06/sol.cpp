@@ -1,17 +1,22 @@
 /*
 Part 1:
-* 1. We first parse the input into a Map object.
+* 1. We first parse the input into a Lab: the obstacles of every row and column, sorted.
 * 2. We then find the carat and its direction.
-* 3. We then move the carat to the next position.
-* 4. We then update the map with the new position of the carat.
-* 5. We repeat the process until the carat is out of bounds or we have found a loop.
-* 6. Finally, we return the total number of visited positions.
+* 3. We jump the carat straight to the cell before the next obstacle in its direction,
+    marking the whole segment as visited with one range fill.
+* 4. We turn right and repeat until the next jump leaves the map.
+* 5. Finally, we return the total number of visited positions.
 
 Part 2:
-* 1. Same as part 1, but we also check if the carat has travelled in the historic path.
-    * Only if the carat is traveling in the same historic PATH AND DIRECTION do we 
-        consider it a loop. 
-* 2. We then return the total number of loops.
+* 1. Only cells on the original path can change the route, so those are the candidates.
+* 2. For each candidate we remember the carat's position and direction just before it
+    first reaches that cell; the path up to there is unaffected by the new obstacle.
+* 3. Each trial resumes from that state on the shared Lab, with the new obstacle as an
+    overlay, and jumps between obstacles until it leaves the map or hits the same
+    obstacle in the same direction twice.
+* 4. Trials are independent, so they are spread across worker threads and the loop
+    counts are summed at the end.
+* 5. We then return the total number of loops.
 */
 #include <iostream>
 #include <fstream>
@@ -21,200 +26,273 @@ Part 2:
 #include <array>
 #include <algorithm>
 #include <utility>
-#include <set>
+#include <cstdint>
+#include <numeric>
+#include <thread>
+#include <atomic>
 
 std::string readFile(const std::string& filename) {
     std::ifstream file(filename);
     return std::string((std::istreambuf_iterator<char>(file)),
                        std::istreambuf_iterator<char>());
 }
-enum class ExitCode {
-    LOOP,
-    SUCCESS,
-    OUT_OF_BOUNDS
+const std::array<char, 4> CARAT_CHARS = {'^', '>', 'v', '<'};
+const std::array<int, 4> DR = {-1, 0, 1, 0};
+const std::array<int, 4> DC = {0, 1, 0, -1};
+
+// Where a straight run of the carat ends: the cell in front of the next
+// obstacle (and that obstacle's id), or the last cell on the map if it walks off.
+struct Stop {
+    int r;
+    int c;
+    bool exits;
+    int obstacle = -1;
 };
 
-// Stores the map and the historic movement of the carat.
-class Map {
-private:
-    std::vector<std::vector<char>> current_map;
-    std::vector<std::vector<std::vector<int>>> history_map;  // 3D map for detect_loop=true
-    std::pair<int, int> current_loc;
-    int current_dir_idx;
-    int time;
-    bool debug;
-    bool detect_loop;
-    bool travelled_in_historic_path;
-    bool turning;
-
-    // returns the position and direction of the carat
-    std::pair<std::pair<int, int>, int> find_carat() {
-        std::array<char, 4> carat_chars = {'^', '>', 'v', '<'};
-        for (int i = 0; i < current_map.size(); i++) {
-            for (int j = 0; j < current_map[0].size(); j++) {
-                for (int idx = 0; idx < 4; idx++) {
-                    if (current_map[i][j] == carat_chars[idx]) {
-                        return {{i, j}, idx};
-                    }
-                }
+// Read-only view of the map for jump walking: for every row the sorted
+// columns of its obstacles, and for every column the sorted rows. Obstacles
+// are numbered in row-major order, so row i's k-th obstacle is
+// row_first_id[i] + k; columns keep their ids alongside.
+struct Lab {
+    int rows = 0;
+    int cols = 0;
+    int start_r = -1;
+    int start_c = -1;
+    int start_dir = -1;
+    std::vector<std::vector<int>> row_obstacles;
+    std::vector<std::vector<int>> col_obstacles;
+    std::vector<int> row_first_id;
+    std::vector<std::vector<int>> col_obstacle_ids;
+    int obstacle_count = 0;
+
+    Lab(const std::string& input) {
+        std::stringstream ss(input);
+        std::string line;
+        std::vector<std::string> lines;
+        while (std::getline(ss, line)) {
+            if (!line.empty()) {
+                lines.push_back(line);
             }
         }
-        return {{-1, -1}, -1};
-    }
 
-    char get_carat_from_dir_idx() {
-        std::array<char, 4> carat_chars = {'^', '>', 'v', '<'};
-        return carat_chars[current_dir_idx];
-    }
+        rows = lines.size();
+        cols = rows == 0 ? 0 : lines[0].size();
+        row_obstacles.resize(rows);
+        col_obstacles.resize(cols);
+        row_first_id.resize(rows);
+        col_obstacle_ids.resize(cols);
 
-    // returns the location of that the carat is facing.
-    std::pair<int, int> find_loc_in_front() {
-        std::pair<int, int> loc = current_loc;
-        switch (current_dir_idx) {
-            case 0: loc.first--; break;  // Up
-            case 1: loc.second++; break; // Right
-            case 2: loc.first++; break;  // Down
-            case 3: loc.second--; break; // Left
-        }
-        
-        if (loc.first < 0 || loc.first >= current_map.size() || 
-            loc.second < 0 || loc.second >= current_map[0].size()) {
-            return {-1, -1};
+        for (int i = 0; i < rows; i++) {
+            row_first_id[i] = obstacle_count;
+            for (int j = 0; j < cols; j++) {
+                char ch = lines[i][j];
+                if (ch == '#') {
+                    row_obstacles[i].push_back(j);
+                    col_obstacles[j].push_back(i);
+                    col_obstacle_ids[j].push_back(obstacle_count++);
+                }
+                auto carat = std::find(CARAT_CHARS.begin(), CARAT_CHARS.end(), ch);
+                if (carat != CARAT_CHARS.end()) {
+                    start_r = i;
+                    start_c = j;
+                    start_dir = carat - CARAT_CHARS.begin();
+                }
+            }
         }
-        return loc;
     }
 
-    // returns the object in front of the carat
-    char find_obj_in_front() {
-        auto loc = find_loc_in_front();
-        if (loc.first == -1) return '\0';
-        return current_map[loc.first][loc.second];
+    // Jumps from (r, c) facing dir to the end of the straight run.
+    Stop next_stop(int r, int c, int dir) const {
+        switch (dir) {
+            case 0: {  // Up
+                const auto& obs = col_obstacles[c];
+                auto it = std::lower_bound(obs.begin(), obs.end(), r);
+                if (it == obs.begin()) return {0, c, true};
+                return {*std::prev(it) + 1, c, false, col_obstacle_ids[c][it - obs.begin() - 1]};
+            }
+            case 1: {  // Right
+                const auto& obs = row_obstacles[r];
+                auto it = std::upper_bound(obs.begin(), obs.end(), c);
+                if (it == obs.end()) return {r, cols - 1, true};
+                return {r, *it - 1, false, row_first_id[r] + static_cast<int>(it - obs.begin())};
+            }
+            case 2: {  // Down
+                const auto& obs = col_obstacles[c];
+                auto it = std::upper_bound(obs.begin(), obs.end(), r);
+                if (it == obs.end()) return {rows - 1, c, true};
+                return {*it - 1, c, false, col_obstacle_ids[c][it - obs.begin()]};
+            }
+            default: {  // Left
+                const auto& obs = row_obstacles[r];
+                auto it = std::lower_bound(obs.begin(), obs.end(), c);
+                if (it == obs.begin()) return {r, 0, true};
+                return {r, *std::prev(it) + 1, false, row_first_id[r] + static_cast<int>(it - obs.begin()) - 1};
+            }
+        }
     }
+};
 
-public:
-    Map(const std::string& input, bool detect_loop = false, bool debug = false) 
-        : debug(debug), detect_loop(detect_loop), time(0), 
-          travelled_in_historic_path(false), turning(false) {
-        
-        std::stringstream ss(input);
-        std::string line;
-        while (std::getline(ss, line)) {
-            current_map.push_back(std::vector<char>(line.begin(), line.end()));
-        }
+int part_1(const std::string& input) {
+    Lab lab(input);
+    std::vector<char> visited(lab.rows * lab.cols, 0);
+    int r = lab.start_r;
+    int c = lab.start_c;
+    int dir = lab.start_dir;
 
-        if (detect_loop) {
-            history_map = std::vector<std::vector<std::vector<int>>>(
-                4, std::vector<std::vector<int>>(
-                    current_map.size(), std::vector<int>(current_map[0].size(), 0)));
+    while (true) {
+        Stop stop = lab.next_stop(r, c, dir);
+        if (dir % 2 == 1) {
+            int row = r * lab.cols;
+            std::fill(visited.begin() + row + std::min(c, stop.c),
+                      visited.begin() + row + std::max(c, stop.c) + 1, 1);
         } else {
-            history_map = std::vector<std::vector<std::vector<int>>>(
-                1, std::vector<std::vector<int>>(
-                    current_map.size(), std::vector<int>(current_map[0].size(), 0)));
+            for (int i = std::min(r, stop.r); i <= std::max(r, stop.r); i++) {
+                visited[i * lab.cols + c] = 1;
+            }
         }
-
-        auto [loc, dir] = find_carat();
-        current_loc = loc;
-        current_dir_idx = dir;
+        if (stop.exits) {
+            break;
+        }
+        r = stop.r;
+        c = stop.c;
+        dir = (dir + 1) % 4;
     }
 
-    // Moves the carat to the next position. Updates the states of the map.
-    ExitCode update() {
-        time++;
-        if (detect_loop) {
-            if (!turning) {
-                if (history_map[current_dir_idx][current_loc.first][current_loc.second] == 1) {
-                    if (travelled_in_historic_path) {
-                        // If the carat has travelled in the historic path, we have found a loop.
-                        return ExitCode::LOOP;
-                    }
-                    travelled_in_historic_path = true;
-                } else {
-                    travelled_in_historic_path = false;
-                }
+    return std::count(visited.begin(), visited.end(), 1);
+}
+
+// A trial obstacle and the carat's state just before it first walks into it.
+struct Candidate {
+    int r;
+    int c;
+    int from_r;
+    int from_c;
+    int dir;
+};
+
+std::vector<Candidate> find_candidates(const Lab& lab) {
+    std::vector<Candidate> candidates;
+    std::vector<char> visited(lab.rows * lab.cols, 0);
+    int r = lab.start_r;
+    int c = lab.start_c;
+    int dir = lab.start_dir;
+    visited[r * lab.cols + c] = 1;
+
+    while (true) {
+        Stop stop = lab.next_stop(r, c, dir);
+        while (r != stop.r || c != stop.c) {
+            int nr = r + DR[dir];
+            int nc = c + DC[dir];
+            if (!visited[nr * lab.cols + nc]) {
+                visited[nr * lab.cols + nc] = 1;
+                candidates.push_back({nr, nc, r, c, dir});
             }
-            history_map[current_dir_idx][current_loc.first][current_loc.second] = 1;
-        } else {
-            history_map[0][current_loc.first][current_loc.second] = 1;
+            r = nr;
+            c = nc;
         }
+        if (stop.exits) {
+            break;
+        }
+        dir = (dir + 1) % 4;
+    }
+
+    return candidates;
+}
+
+// Per-thread record of (obstacle, direction) states hit in the current trial.
+// A state counts as seen only if it carries the current generation, so moving
+// on to the next trial is a counter bump rather than a clear.
+struct VisitedStates {
+    std::vector<uint32_t> stamps;
+    uint32_t generation = 0;
 
-        char obj_in_front = find_obj_in_front();
-        if (obj_in_front == '.') {
-            current_map[current_loc.first][current_loc.second] = '.';
-            current_loc = find_loc_in_front();
-            current_map[current_loc.first][current_loc.second] = get_carat_from_dir_idx();
-            turning = false;
-        } else if (obj_in_front == '#') {
-            current_dir_idx = (current_dir_idx + 1) % 4;
-            turning = true;
-        } else if (obj_in_front == '\0') {
-            return ExitCode::OUT_OF_BOUNDS;
+    VisitedStates(int obstacles) : stamps(obstacles * 4, 0) {}
+
+    void next_trial() {
+        if (++generation == 0) {
+            std::fill(stamps.begin(), stamps.end(), 0);
+            generation = 1;
         }
-        return ExitCode::SUCCESS;
     }
 
-    // Returns the total number of visited positions.
-    int get_total_visited() {
-        int sum = 0;
-        for (int i = 0; i < current_map.size(); i++) {
-            for (int j = 0; j < current_map[0].size(); j++) {
-                if (!detect_loop) {
-                    sum += history_map[0][i][j];
-                } else {
-                    for (int k = 0; k < 4; k++) {
-                        if (history_map[k][i][j] > 0) {
-                            sum++;
-                            break;
-                        }
-                    }
-                }
-            }
+    // Marks the state and returns whether it had already been seen.
+    bool visit(int state) {
+        if (stamps[state] == generation) {
+            return true;
         }
-        return sum;
+        stamps[state] = generation;
+        return false;
     }
+};
 
-    void set_obstacle(int i, int j) {
-        current_map[i][j] = '#';
+// Same as Lab::next_stop, but with the candidate's obstacle (id
+// lab.obstacle_count) added on top of the lab.
+Stop next_stop_with(const Lab& lab, const Candidate& candidate, int r, int c, int dir) {
+    Stop stop = lab.next_stop(r, c, dir);
+    bool blocks = false;
+    switch (dir) {
+        case 0: blocks = candidate.c == c && candidate.r < r && candidate.r >= stop.r; break;
+        case 1: blocks = candidate.r == r && candidate.c > c && candidate.c <= stop.c; break;
+        case 2: blocks = candidate.c == c && candidate.r > r && candidate.r <= stop.r; break;
+        case 3: blocks = candidate.r == r && candidate.c < c && candidate.c >= stop.c; break;
+    }
+    if (blocks) {
+        return {candidate.r - DR[dir], candidate.c - DC[dir], false, lab.obstacle_count};
     }
+    return stop;
+}
 
-    std::vector<std::pair<int, int>> get_dot_locations() {
-        std::vector<std::pair<int, int>> dots;
-        for (int i = 0; i < current_map.size(); i++) {
-            for (int j = 0; j < current_map[0].size(); j++) {
-                if (current_map[i][j] == '.') {
-                    dots.push_back({i, j});
-                }
-            }
+// Jumps from the candidate's branching point from obstacle to obstacle. A
+// loop must come back to an obstacle it already hit in the same direction, so
+// only those turn states are recorded.
+bool trial_loops(const Lab& lab, const Candidate& candidate, VisitedStates& seen) {
+    int r = candidate.from_r;
+    int c = candidate.from_c;
+    int dir = candidate.dir;
+    seen.next_trial();
+
+    while (true) {
+        Stop stop = next_stop_with(lab, candidate, r, c, dir);
+        if (stop.exits) {
+            return false;
         }
-        return dots;
+        if (seen.visit(stop.obstacle * 4 + dir)) {
+            return true;
+        }
+        r = stop.r;
+        c = stop.c;
+        dir = (dir + 1) % 4;
     }
-};
-
-int part_1(const std::string& input) {
-    Map map(input);
-    while (map.update() == ExitCode::SUCCESS) {}
-    return map.get_total_visited();
 }
 
+// Candidates are independent, so worker threads pull them from a shared
+// counter, each with its own VisitedStates, and the loop counts are summed.
 int part_2(const std::string& input) {
-    Map og_map(input, true);
-    auto dot_loc_list = og_map.get_dot_locations();
-    int total_loops = 0;
-
-    for (const auto& loc : dot_loc_list) {
-        Map map(input, true);
-        map.set_obstacle(loc.first, loc.second);
-        
-        while (true) {
-            ExitCode exit_code = map.update();
-            if (exit_code == ExitCode::LOOP) {
-                total_loops++;
-                break;
-            } else if (exit_code == ExitCode::OUT_OF_BOUNDS) {
-                break;
+    Lab lab(input);
+    std::vector<Candidate> candidates = find_candidates(lab);
+    int threads = std::clamp<int>(std::thread::hardware_concurrency(), 1, std::max<int>(candidates.size(), 1));
+
+    std::atomic<size_t> next_candidate = 0;
+    std::vector<int> loops(threads, 0);
+    std::vector<std::thread> workers;
+
+    for (int t = 0; t < threads; t++) {
+        workers.emplace_back([&, t] {
+            VisitedStates seen(lab.obstacle_count + 1);
+            int count = 0;
+            for (size_t i = next_candidate++; i < candidates.size(); i = next_candidate++) {
+                if (trial_loops(lab, candidates[i], seen)) {
+                    count++;
+                }
             }
-        }
+            loops[t] = count;
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
     }
-    return total_loops;
+
+    return std::accumulate(loops.begin(), loops.end(), 0);
 }
 
 int main() {
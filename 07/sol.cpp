@@ -1,20 +1,28 @@
 /*
 Part 1:
 * 1. We first parse the input into a list of numbers and the target number.
-* 2. We then find all the possible combinations of operators that can be used to equate the target number.
-* 3. We then check if the target number can be equated using the operators. 
-     * There is probably huristics to filter out some of the combinations. But here we use BruteForce™.
-* 4. If it can, we add the target number to the tally.
-* 5. Finally, we return the tally.
+* 2. We then work backwards from the target, undoing the last operator at each step:
+     * '+' by subtracting the last number,
+     * '*' by dividing, only when the last number divides the target.
+     Branches that cannot be undone are dropped immediately.
+* 3. If the first number is what remains, the target can be equated and we add it to the tally.
+* 4. Finally, we return the tally.
 
 Part 2:
-* 1. Same as part 1, but we add the || operator to the possible operators.
+* 1. Same as part 1, but '||' is also undone, only when the target ends in the last number's digits.
+* 2. Equations that already hold in part 1 hold here too, so only part 1 failures are searched again.
+* 3. Both parts are solved together, with the equations spread across worker threads.
 */
 #include <iostream>
 #include <fstream>
 #include <string>
 #include <sstream>
 #include <vector>
+#include <array>
+#include <algorithm>
+#include <unordered_set>
+#include <thread>
+#include <atomic>
 
 std::string readFile(const std::string& filename) {
     std::ifstream file(filename);
@@ -33,88 +41,184 @@ std::vector<std::string> split(const std::string& str, const std::string& delim)
     return tokens;
 }
 
-std::vector<int> parse_numbers(const std::string& str) {
-    std::vector<int> numbers;
+using Value = unsigned long long;
+using Wide = unsigned __int128;
+
+std::vector<Value> parse_numbers(const std::string& str) {
+    std::vector<Value> numbers;
     std::istringstream iss(str);
-    int num;
+    Value num;
     while (iss >> num) {
         numbers.push_back(num);
     }
     return numbers;
 }
 
-void generate_combinations(std::vector<std::vector<std::string>>& all_combinations,
-                         const std::vector<std::string>& possible_operators,
-                         std::vector<std::string>& current,
-                         size_t length) {
-    if (current.size() == length) {
-        all_combinations.push_back(current);
-        return;
-    }
-    for (const auto& op : possible_operators) {
-        current.push_back(op);
-        generate_combinations(all_combinations, possible_operators, current, length);
-        current.pop_back();
+std::string to_string(Wide value) {
+    std::string digits;
+    do {
+        digits.insert(digits.begin(), '0' + static_cast<int>(value % 10));
+        value /= 10;
+    } while (value != 0);
+    return digits;
+}
+
+// POW10[i] == 10^i. 10^20 is the first power past any 64-bit operand, so it
+// is kept in 128 bits.
+constexpr std::array<Wide, 21> POW10 = [] {
+    std::array<Wide, 21> pow10{};
+    pow10[0] = 1;
+    for (size_t i = 1; i < pow10.size(); i++) {
+        pow10[i] = pow10[i - 1] * 10;
     }
+    return pow10;
+}();
+
+// Smallest power of ten greater than x, i.e. the factor `a || x` shifts a by.
+Wide concat_shift(Value x) {
+    return *std::upper_bound(POW10.begin() + 1, POW10.end(), static_cast<Wide>(x));
 }
 
-bool can_equate(long long target, const std::vector<int>& rest, int part_num) {
-    std::vector<std::string> possible_operators;
-    if (part_num == 1) {
-        possible_operators = {"+", "*"};
-    } else {
-        possible_operators = {"+", "*", "||"};
+// Below this many operands the search tree is small enough that hashing
+// states costs more than re-exploring them.
+const size_t MEMO_MIN_OPERANDS = 12;
+
+// Whether the first `count` operands can evaluate to target. Works from the
+// last operand back: '+' is undone by subtraction, '*' only when it divides
+// the target and '||' only when the target ends in the operand's digits, so
+// dead branches are cut before recursing into them. Every operator is
+// non-decreasing, so a branch whose remainder would go below zero is dead;
+// undoing only ever shrinks the target, so nothing here can overflow.
+//
+// For long equations, (count, target) states already known to fail are
+// remembered, since different operator suffixes often leave the same
+// remainder for the same prefix.
+struct EquationSolver {
+    const std::vector<Value>& rest;
+    bool allow_concat;
+    bool memoize;
+    std::vector<std::unordered_set<Value>> dead;
+
+    EquationSolver(const std::vector<Value>& rest, bool allow_concat)
+        : rest(rest), allow_concat(allow_concat), memoize(rest.size() >= MEMO_MIN_OPERANDS) {
+        if (memoize) {
+            dead.resize(rest.size() + 1);
+        }
     }
-    
-    std::vector<std::vector<std::string>> all_combinations;
-    std::vector<std::string> current;
-    generate_combinations(all_combinations, possible_operators, current, rest.size() - 1);
-    
-    for (const auto& ops : all_combinations) {
-        long long current_value = rest[0];
-        for (size_t i = 0; i < ops.size(); ++i) {
-            if (ops[i] == "||") {
-                std::string combined = std::to_string(current_value) + std::to_string(rest[i + 1]);
-                current_value = std::stoll(combined);
-            } else if (ops[i] == "+") {
-                current_value += rest[i + 1];
-            } else if (ops[i] == "*") {
-                current_value *= rest[i + 1];
-            }
+
+    bool can_reach(Value target, size_t count) {
+        Value last = rest[count - 1];
+        if (count == 1) {
+            return target == last;
+        }
+        if (memoize && dead[count].count(target)) {
+            return false;
         }
-        if (current_value == target) {
+
+        if (target >= last && can_reach(target - last, count - 1)) {
+            return true;
+        }
+        if (last == 0) {
+            if (target == 0) {
+                return true;
+            }
+        } else if (target % last == 0 && can_reach(target / last, count - 1)) {
             return true;
         }
+        if (allow_concat) {
+            Wide shift = concat_shift(last);
+            if (target % shift == last && can_reach(target / shift, count - 1)) {
+                return true;
+            }
+        }
+
+        if (memoize) {
+            dead[count].insert(target);
+        }
+        return false;
     }
-    return false;
+};
+
+bool can_equate(Value target, const std::vector<Value>& rest, int part_num) {
+    return EquationSolver(rest, part_num == 2).can_reach(target, rest.size());
 }
 
-long solve(const std::string& input, int part_num) {
-    long tally = 0;
+struct Equation {
+    Value target;
+    std::vector<Value> rest;
+};
+
+// Tallies are kept in 128 bits so summing many 64-bit targets cannot wrap.
+struct Tallies {
+    Wide part_1 = 0;
+    Wide part_2 = 0;
+};
+
+// Solves both parts in one pass. An equation that holds with '+' and '*'
+// also holds in part 2, so '||' is only searched for part 1 failures.
+// Equations are independent and handed out to worker threads in chunks;
+// each thread keeps its own tallies, which are summed at the end.
+Tallies solve(const std::string& input) {
+    std::vector<Equation> equations;
     std::istringstream iss(input);
     std::string line;
     
     while (std::getline(iss, line)) {
-        auto parts = split(line, ": ");
-        long long target = std::stoll(parts[0]);
-        auto rest = parse_numbers(parts[1]);
-        
-        if ((part_num == 1 && can_equate(target, rest, 1)) ||
-            (part_num == 2 && can_equate(target, rest, 2))) {
-            tally += target;
+        if (line.empty()) {
+            continue;
         }
+        auto parts = split(line, ": ");
+        equations.push_back({std::stoull(parts[0]), parse_numbers(parts[1])});
     }
-    return tally;
+
+    const size_t chunk = 256;
+    size_t chunks = (equations.size() + chunk - 1) / chunk;
+    int threads = std::clamp<int>(std::thread::hardware_concurrency(), 1, std::max<size_t>(chunks, 1));
+    std::atomic<size_t> next_chunk = 0;
+    std::vector<Tallies> partial(threads);
+    std::vector<std::thread> workers;
+
+    for (int t = 0; t < threads; t++) {
+        workers.emplace_back([&, t] {
+            Tallies local;
+            for (size_t begin = next_chunk.fetch_add(chunk); begin < equations.size(); begin = next_chunk.fetch_add(chunk)) {
+                size_t end = std::min(begin + chunk, equations.size());
+                for (size_t i = begin; i < end; i++) {
+                    const auto& [target, rest] = equations[i];
+                    if (can_equate(target, rest, 1)) {
+                        local.part_1 += target;
+                        local.part_2 += target;
+                    } else if (can_equate(target, rest, 2)) {
+                        local.part_2 += target;
+                    }
+                }
+            }
+            partial[t] = local;
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    Tallies tallies;
+    for (const auto& t : partial) {
+        tallies.part_1 += t.part_1;
+        tallies.part_2 += t.part_2;
+    }
+    return tallies;
 }
 
 int main() {
     std::string test_input = readFile("test_input.txt");
     std::string input = readFile("input.txt");
 
-    std::cout << "part_1_test: " << solve(test_input, 1) << std::endl;
-    std::cout << "part_1:      " << solve(input, 1) << std::endl;
-    std::cout << "part_2_test: " << solve(test_input, 2) << std::endl;
-    std::cout << "part_2:      " << solve(input, 2) << std::endl;
+    Tallies test_tallies = solve(test_input);
+    Tallies tallies = solve(input);
+
+    std::cout << "part_1_test: " << to_string(test_tallies.part_1) << std::endl;
+    std::cout << "part_1:      " << to_string(tallies.part_1) << std::endl;
+    std::cout << "part_2_test: " << to_string(test_tallies.part_2) << std::endl;
+    std::cout << "part_2:      " << to_string(tallies.part_2) << std::endl;
 
     return 0;
 }
\ No newline at end of file
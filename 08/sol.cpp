@@ -1,17 +1,19 @@
 /*
 Part 1:
-* 1. First, we convert the input into a 2D vector of characters.
-* 2. Then, we find all the positions of the unique frequences.
-* 3. We then use combinatorials of the positions to find all the unique paris of positions.
+* 1. First, we scan the input once, bucketing the antenna positions by frequency.
+* 2. Antinodes are marked in bitset grids, one per worker thread, OR-ed together at the end.
+* 3. We then generate all the unique pairs of positions of a frequency on the fly, spread across the threads.
 * 4. For each pair, we first find the delta position in x and y, 
 * 5. Then find the two antinode positions by subtracting and adding the delta position.
 * 6. We then check if the antinode positions are within the bounds of the map.
-* 7. Finally, we calculate the total number of antinode positions.
+* 7. Finally, we popcount the grid for the total number of antinode positions.
 
 Part 2:
 * 1. Same at step 1-5 in part 1.
-* 2. Instead of finding the + and - delta positions, we find all the integer multiples of the delta position.
-* 3. We then check if the harmonics positions are within the bounds of the map.
+* 2. Instead of finding the + and - delta positions, we find all the integer multiples of the delta position,
+     reduced by its gcd so that grid points between the two antennas are included.
+* 3. The range of multiples that stays within the map is solved for directly, and the line is written
+     straight into the grid.
 * 4. Finally, we calculate the total number of harmonics positions.
 */
 #include <iostream>
@@ -19,7 +21,14 @@ Part 2:
 #include <string>
 #include <sstream>
 #include <vector>
-#include <set>
+#include <array>
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <thread>
+#include <atomic>
 
 std::string readFile(const std::string& filename) {
     std::ifstream file(filename);
@@ -27,48 +36,95 @@ std::string readFile(const std::string& filename) {
                        std::istreambuf_iterator<char>());
 }
 
-std::vector<std::vector<char>> parse_input_to_2d_vector(const std::string& input) {
-    std::vector<std::vector<char>> result;
-    std::stringstream ss(input);
-    std::string line;
-    while (std::getline(ss, line)) {
-        result.push_back(std::vector<char>(line.begin(), line.end()));
+// One bit per map cell, shared by every frequency so antinodes are OR-ed in
+// place instead of merging a full grid per frequency.
+struct AntinodeGrid {
+    int rows = 0;
+    int cols = 0;
+    int words = 0;
+    std::vector<uint64_t> bits;
+
+    AntinodeGrid(int rows, int cols)
+        : rows(rows), cols(cols), words((cols + 63) / 64), bits(static_cast<size_t>(rows) * words, 0) {}
+
+    bool in_bounds(const std::pair<int, int>& position) const {
+        return position.first >= 0 && position.first < rows && position.second >= 0 && position.second < cols;
+    }
+
+    void set(const std::pair<int, int>& position) {
+        bits[static_cast<size_t>(position.first) * words + position.second / 64] |= uint64_t{1} << (position.second % 64);
+    }
+
+    // Sets columns [c_0, c_1] of one row, a word at a time.
+    void set_run(int row, int c_0, int c_1) {
+        uint64_t* row_bits = bits.data() + static_cast<size_t>(row) * words;
+        for (int w = c_0 / 64; w <= c_1 / 64; ++w) {
+            int lo = std::max(c_0, w * 64) - w * 64;
+            int hi = std::min(c_1, w * 64 + 63) - w * 64;
+            uint64_t mask = (hi == 63 ? ~uint64_t{0} : (uint64_t{1} << (hi + 1)) - 1) & ~((uint64_t{1} << lo) - 1);
+            row_bits[w] |= mask;
+        }
+    }
+
+    void merge(const AntinodeGrid& other) {
+        for (size_t w = 0; w < bits.size(); ++w) {
+            bits[w] |= other.bits[w];
+        }
+    }
+
+    int count() const {
+        int total = 0;
+        for (uint64_t word : bits) {
+            total += std::popcount(word);
+        }
+        return total;
+    }
+};
+
+// Narrows [t_min, t_max] to the t keeping p + t * step inside [0, size).
+// p itself must be in bounds, so every numerator below is non-negative and
+// integer division is the floor.
+void axis_range(int p, int step, int size, int& t_min, int& t_max) {
+    if (step > 0) {
+        t_min = std::max(t_min, -(p / step));
+        t_max = std::min(t_max, (size - 1 - p) / step);
+    } else if (step < 0) {
+        t_min = std::max(t_min, -((size - 1 - p) / -step));
+        t_max = std::min(t_max, p / -step);
     }
-    return result;
 }
 
-template<typename T>
-void print_2d_vector(const std::vector<std::vector<T>>& vec) {
-    std::cout << "----- print_2d_vector -----" << std::endl;
-    for (const auto& row : vec) {
-        for (const auto& elem : row) {
-            std::cout << elem << " ";
+// Antenna positions bucketed by frequency character in one scan of the map.
+struct AntennaMap {
+    int rows = 0;
+    int cols = 0;
+    std::array<std::vector<std::pair<int, int>>, 256> positions;
+};
+
+AntennaMap parse_antennas(const std::string& input) {
+    AntennaMap antennas;
+    std::stringstream ss(input);
+    std::string line;
+    while (std::getline(ss, line)) {
+        if (line.empty()) {
+            continue;
+        }
+        for (int j = 0; j < static_cast<int>(line.size()); ++j) {
+            if (line[j] != '.' && line[j] != '#') {
+                antennas.positions[static_cast<unsigned char>(line[j])].push_back({antennas.rows, j});
+            }
         }
-        std::cout << std::endl;
+        antennas.cols = std::max<int>(antennas.cols, line.size());
+        antennas.rows++;
     }
-    std::cout << "----- end -----" << std::endl;
+    return antennas;
 }
 
 // Each instance of AntennaArray is for a single frequency.
 // Has processing methods for finding antinode and harmonics positions.
 class AntennaArray {
 private:
-    char frequency;
-    std::vector<std::vector<char>> map_array;
-    std::vector<std::pair<int, int>> positions;
-    std::vector<std::vector<int>> antinode_map;
-
-    std::vector<std::pair<int, int>> find_positions() {
-        std::vector<std::pair<int, int>> positions;
-        for (int i = 0; i < map_array.size(); ++i) {
-            for (int j = 0; j < map_array[0].size(); ++j) {
-                if (map_array[i][j] == frequency) {
-                    positions.push_back({i, j});
-                }
-            }
-        }
-        return positions;
-    }
+    const std::vector<std::pair<int, int>>& positions;
 
     std::pair<std::pair<int, int>, std::pair<int, int>> find_antinode_positions(const std::pair<int, int>& pos_0, const std::pair<int, int>& pos_1) {
         auto delta_position = std::make_pair(pos_1.first - pos_0.first, pos_1.second - pos_0.second);
@@ -77,114 +133,109 @@ private:
         return std::make_pair(antinode_0, antinode_1);
     }
 
-    bool check_position_is_in_bounds(const std::pair<int, int>& position) {
-        return position.first >= 0 && position.first < map_array.size() && position.second >= 0 && position.second < map_array[0].size();
-    }
-
-    template<typename T>
-    std::vector<std::pair<T, T>> get_combinations(const std::vector<T>& items) {
-        std::vector<std::pair<T, T>> result;
-        for (size_t i = 0; i < items.size(); ++i) {
-            for (size_t j = i + 1; j < items.size(); ++j) {
-                result.push_back({items[i], items[j]});
-            }
+    // Marks every grid point on the line through both antennas. The delta is
+    // reduced by its gcd so points between the antennas are not skipped, and
+    // the in-bounds range of the line parameter t is solved for directly
+    // instead of probing each step.
+    void mark_harmonics_line(const std::pair<int, int>& pos_0, const std::pair<int, int>& pos_1, AntinodeGrid& grid) {
+        int dr = pos_1.first - pos_0.first;
+        int dc = pos_1.second - pos_0.second;
+        int g = std::gcd(dr, dc);
+        dr /= g;
+        dc /= g;
+
+        int t_min = std::numeric_limits<int>::min();
+        int t_max = std::numeric_limits<int>::max();
+        axis_range(pos_0.first, dr, grid.rows, t_min, t_max);
+        axis_range(pos_0.second, dc, grid.cols, t_min, t_max);
+        if (t_min > t_max) {
+            return;
         }
-        return result;
-    }
 
-    std::vector<std::pair<int, int>> find_harmonics_positions(const std::pair<int, int>& pos_0, const std::pair<int, int>& pos_1) {
-        auto delta_position = std::make_pair(pos_1.first - pos_0.first, pos_1.second - pos_0.second);
-        std::vector<std::pair<int, int>> total_harmonics_positions;
-        
-        for (int i = 0; ; ++i) {
-            auto harmonic_0 = std::make_pair(
-                pos_0.first - i * delta_position.first,
-                pos_0.second - i * delta_position.second
-            );
-            if (!check_position_is_in_bounds(harmonic_0)) break;
-            total_harmonics_positions.push_back(harmonic_0);
+        if (dr == 0) {
+            int c_0 = pos_0.second + t_min * dc;
+            int c_1 = pos_0.second + t_max * dc;
+            grid.set_run(pos_0.first, std::min(c_0, c_1), std::max(c_0, c_1));
+            return;
         }
-        
-        for (int i = 0; ; ++i) {
-            auto harmonic_1 = std::make_pair(
-                pos_1.first + i * delta_position.first,
-                pos_1.second + i * delta_position.second
-            );
-            if (!check_position_is_in_bounds(harmonic_1)) break;
-            total_harmonics_positions.push_back(harmonic_1);
+        for (int t = t_min; t <= t_max; ++t) {
+            grid.set({pos_0.first + t * dr, pos_0.second + t * dc});
         }
-        
-        return total_harmonics_positions;
     }
 
 public:
-    AntennaArray(char frequency, const std::vector<std::vector<char>>& map_array) 
-        : frequency(frequency), map_array(map_array) {
-        positions = find_positions();
-        antinode_map = std::vector<std::vector<int>>(map_array.size(), std::vector<int>(map_array[0].size(), 0));
+    AntennaArray(const std::vector<std::pair<int, int>>& positions) : positions(positions) {}
+
+    size_t size() const {
+        return positions.size();
     }
 
-    std::vector<std::vector<int>> find_all_antinode_positions() {
-        auto position_pairs = get_combinations(positions);
-        for (const auto& [pos_0, pos_1] : position_pairs) {
-            auto [antinode_0, antinode_1] = find_antinode_positions(pos_0, pos_1);
+    // Marks the antinodes of every pair (i, j) with j > i, generating the
+    // pairs on the fly.
+    void find_antinode_positions_from(size_t i, AntinodeGrid& grid) {
+        for (size_t j = i + 1; j < positions.size(); ++j) {
+            auto [antinode_0, antinode_1] = find_antinode_positions(positions[i], positions[j]);
             
-            if (check_position_is_in_bounds(antinode_0)) {
-                antinode_map[antinode_0.first][antinode_0.second] = 1;
+            if (grid.in_bounds(antinode_0)) {
+                grid.set(antinode_0);
             }
-            if (check_position_is_in_bounds(antinode_1)) {
-                antinode_map[antinode_1.first][antinode_1.second] = 1;
+            if (grid.in_bounds(antinode_1)) {
+                grid.set(antinode_1);
             }
         }
-        return antinode_map;
     }
 
-    std::vector<std::vector<int>> find_all_harmonics_positions() {
-        auto position_pairs = get_combinations(positions);
-        auto harmonics_map = std::vector<std::vector<int>>(map_array.size(), std::vector<int>(map_array[0].size(), 0));
-        for (const auto& [pos_0, pos_1] : position_pairs) {
-            auto harmonics_positions = find_harmonics_positions(pos_0, pos_1);
-            for (const auto& harmonic_position : harmonics_positions) {
-                harmonics_map[harmonic_position.first][harmonic_position.second] = 1;
-            }
+    void find_harmonics_positions_from(size_t i, AntinodeGrid& grid) {
+        for (size_t j = i + 1; j < positions.size(); ++j) {
+            mark_harmonics_line(positions[i], positions[j], grid);
         }
-        return harmonics_map;
     }
 
 };
 
+// The work is every antenna of every frequency, each standing for its pairs
+// with the later antennas of the same frequency. Worker threads pull these
+// from a shared counter and mark a grid of their own; the grids are OR-ed
+// together at the end and popcounted for the total.
 int solve(const std::string& input, bool part_1) {  
-    std::vector<std::vector<char>> map_array = parse_input_to_2d_vector(input);
-    std::set<char> freq_set;
-    for (const auto& row : map_array) {
-        for (char c : row) {
-            if (c != '.' && c != '#') {
-                freq_set.insert(c);
-            }
+    AntennaMap antennas = parse_antennas(input);
+    std::vector<AntennaArray> arrays;
+    std::vector<std::pair<size_t, size_t>> work;
+    for (const auto& positions : antennas.positions) {
+        if (positions.size() < 2) {
+            continue;
         }
-    }
-    int total = 0;
-    auto antinode_map = std::vector<std::vector<int>>(map_array.size(), std::vector<int>(map_array[0].size(), 0));
-    for (char freq : freq_set) {
-        AntennaArray antenna_array(freq, map_array);
-        auto current_antinode_map = std::vector<std::vector<int>>(map_array.size(), std::vector<int>(map_array[0].size(), 0));        if (part_1) {
-            current_antinode_map = antenna_array.find_all_antinode_positions();
-        } else {
-            current_antinode_map = antenna_array.find_all_harmonics_positions();
+        arrays.emplace_back(positions);
+        for (size_t i = 0; i + 1 < positions.size(); ++i) {
+            work.push_back({arrays.size() - 1, i});
         }
-        for (int i = 0; i < antinode_map.size(); ++i) {
-            for (int j = 0; j < antinode_map[0].size(); ++j) {
-                antinode_map[i][j] = antinode_map[i][j] or current_antinode_map[i][j];
+    }
+
+    int threads = std::clamp<int>(std::thread::hardware_concurrency(), 1, std::max<int>(work.size(), 1));
+    std::vector<AntinodeGrid> grids(threads, AntinodeGrid(antennas.rows, antennas.cols));
+    std::atomic<size_t> next_item = 0;
+    std::vector<std::thread> workers;
+
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t] {
+            for (size_t k = next_item++; k < work.size(); k = next_item++) {
+                auto [array, i] = work[k];
+                if (part_1) {
+                    arrays[array].find_antinode_positions_from(i, grids[t]);
+                } else {
+                    arrays[array].find_harmonics_positions_from(i, grids[t]);
+                }
             }
-        }
+        });
     }
-    // print_2d_vector(antinode_map);
-    for (const auto& row : antinode_map) {
-        for (int elem : row) {
-            total += elem;
-        }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    for (int t = 1; t < threads; ++t) {
+        grids[0].merge(grids[t]);
     }
-    return total;
+    return grids[0].count();
 }
 
 
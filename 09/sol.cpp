@@ -1,27 +1,31 @@
 /*
-Part 1 (brute force solution, takes about 20 seconds to compute):
+Part 1 (single O(n) pass, O(number of files) memory):
 - First, we convert the input into pairs, representing the used and unused space.
-- Then, we convert the pairs into data blocks.
-- Then, we iteratively move the last data block to the first empty space until
-  all data blocks are moved.
-- Finally, we calculate the checksum of the blocks.
+- Then, one pointer walks forward over the pairs and one walks backward over the files;
+  every empty space the first meets is filled with the tail of the file under the second.
+- The checksum of each placed run is accumulated in closed form, so the disk is never
+  expanded into individual blocks.
 
-Part 2 (pretty fast, < 1 second):
+Part 2 (O(n log n)):
 - First, we convert the input into pairs, representing the used and unused space.
-- Then, we convert the pairs into data blocks.
-- Then, we iteratively move the last data block to the first empty space until 
-  all data blocks are moved.
-  - This step is complicated by the fact that we need to first find the first 
-    contiguous free space of the given size, and then move the file to the 
-    first empty space.
-- Finally, we calculate the checksum of the blocks.
+- Then, we lay the pairs out as (file id, start, length) spans and free spans.
+- Free runs separated only by an empty file are merged into one span, which may be
+  longer than 9.
+- Free spans go into nine min-heaps keyed by their size, 1 to 9, where the last heap
+  holds every span of 9 or more.
+- From the last file to the first, we move each file to the leftmost free span that
+  fits it, found from the tops of the heaps for sizes >= the file's length.
+- The checksum of every file span is computed in closed form.
 */
 #include <iostream>
 #include <fstream>
 #include <string>
 #include <sstream>
 #include <vector>
-#include <set>
+#include <array>
+#include <algorithm>
+#include <queue>
+#include <functional>
 
 std::string readFile(const std::string& filename) {
     std::ifstream file(filename);
@@ -50,142 +54,127 @@ std::vector<std::pair<int, int>> parseStrToPairs(const std::string& input) {
     return pairs;
 }
 
-// Assigns the pairs into data blocks. Empty space is represented by -1.
-std::vector<std::vector<int>> pairsToBlocks(const std::vector<std::pair<int, int>>& pairs) {
-    std::vector<std::vector<int>> blocks;
+// A contiguous run on the disk. Free spans carry id -1.
+struct Span {
+    int id;
+    unsigned long long start;
+    int length;
+};
+
+// Checksum contribution of a file span: id * (start + ... + start + length - 1).
+unsigned long long spanChecksum(int id, unsigned long long start, int length) {
+    unsigned long long len = length;
+    return (unsigned long long)id * (len * start + len * (len - 1) / 2);
+}
+
+// Lays the pairs out as file spans (indexed by file id) and free spans, in
+// disk order, without expanding them into blocks. A free run that directly
+// follows the previous one (the file between them is empty) extends it.
+void layoutSpans(const std::vector<std::pair<int, int>>& pairs, std::vector<Span>& files, std::vector<Span>& frees) {
+    unsigned long long position = 0;
     for (size_t i = 0; i < pairs.size(); i++) {
-        std::vector<int> block;
-        for (int j = 0; j < pairs[i].first; j++) {
-            block.push_back(i);
-        }
-        for (int j = 0; j < pairs[i].second; j++) {
-            block.push_back(-1);
+        files.push_back({(int)i, position, pairs[i].first});
+        position += pairs[i].first;
+        if (pairs[i].second > 0) {
+            if (!frees.empty() && frees.back().start + frees.back().length == position) {
+                frees.back().length += pairs[i].second;
+            } else {
+                frees.push_back({-1, position, pairs[i].second});
+            }
         }
-        blocks.push_back(block);
+        position += pairs[i].second;
     }
-    return blocks;
 }
 
-// Converts the input into a single vector of blocks.
-std::vector<int> expandIntoBlocks(const std::string& input) {
+// Compacts the disk straight from the pairs, never expanding them into
+// blocks: file `left` stays where it is, then its free space is filled with
+// the tail of file `right`, moving on to earlier files as each is used up.
+// Every placed run is added to the checksum in closed form.
+unsigned long long part1(const std::string& input) {
     auto pairs = parseStrToPairs(input);
-    auto blocks = pairsToBlocks(pairs);
-    
-    std::vector<int> result;
-    for (const auto& block : blocks) {
-        result.insert(result.end(), block.begin(), block.end());
+    unsigned long long sum = 0;
+    if (pairs.empty()) {
+        return sum;
     }
-    return result;
-}
 
-// Moves last data block to the first empty space.
-std::vector<int> moveOneBlock(const std::vector<int>& blocks) {
-    std::vector<int> newBlocks(blocks.begin(), blocks.end() - 1);
-    auto it = std::find(newBlocks.begin(), newBlocks.end(), -1);
-    if (it != newBlocks.end()) {
-        *it = blocks.back();
-    }
-    return newBlocks;
-}
+    unsigned long long position = 0;
+    size_t right = pairs.size() - 1;
+    int right_remaining = pairs[right].first;
 
-// Calculates the checksum of the blocks. It's important to use unsigned long long
-// to avoid overflow.
-unsigned long long checksum(const std::vector<int>& blocks) {
-    unsigned long long sum = 0;
-    for (size_t i = 0; i < blocks.size(); i++) {
-        sum += (unsigned long long)blocks[i] * i;
-    }
-    return sum;
-}
+    for (size_t left = 0; left <= right; left++) {
+        int length = left == right ? right_remaining : pairs[left].first;
+        sum += spanChecksum(left, position, length);
+        position += length;
 
-// Finds the start and end index of the contiguous file of the given value.
-std::pair<size_t, size_t> findContiguousFile(const std::vector<int>& blocks, int value) {
-    size_t start_idx = 0;
-    size_t end_idx = 0;
-    bool found_start = false;
-    
-    for (size_t i = 0; i < blocks.size(); i++) {
-        if (blocks[i] == value) {
-            if (!found_start) {
-                start_idx = i;
-                found_start = true;
+        int free_space = pairs[left].second;
+        while (free_space > 0 && right > left) {
+            int moved = std::min(free_space, right_remaining);
+            sum += spanChecksum(right, position, moved);
+            position += moved;
+            free_space -= moved;
+            right_remaining -= moved;
+            if (right_remaining == 0) {
+                right--;
+                right_remaining = pairs[right].first;
             }
-            end_idx = i;
         }
     }
-    return {start_idx, end_idx};
+    return sum;
 }
 
-// Changes the file to None, represented by -1.
-std::vector<int> changeFileToNone(std::vector<int> blocks, int value) {
-    for (auto& block : blocks) {
-        if (block == value) {
-            block = -1;
-        }
-    }
-    return blocks;
-}
+// Free spans are kept in nine min-heaps of (start, length), one per span
+// size, with every span of 9 or more in the last one. A file of length n
+// (at most 9) goes to the leftmost span among the heaps for sizes n..9, if
+// that lies left of the file; what is left of the span goes back into the
+// heap for its new size. Space freed by a moved file is never reused, since
+// every file still to move lies to its left.
+unsigned long long part2(const std::string& input) {
+    std::vector<Span> files;
+    std::vector<Span> frees;
+    layoutSpans(parseStrToPairs(input), files, frees);
 
-// Finds the first contiguous free space of the given size.
-size_t findFirstContiguousFreeSpace(const std::vector<int>& blocks, size_t free_space_size) {
-    size_t free_space_count = 0;
-    for (size_t i = 0; i < blocks.size(); i++) {
-        if (blocks[i] == -1) {
-            free_space_count++;
-        } else {
-            free_space_count = 0;
-        }
-        if (free_space_count == free_space_size) {
-            return i - free_space_size + 1;
-        }
+    using FreeSpan = std::pair<unsigned long long, int>;
+    using MinHeap = std::priority_queue<FreeSpan, std::vector<FreeSpan>, std::greater<>>;
+    std::array<MinHeap, 10> free_by_size;
+    auto push_free = [&free_by_size](unsigned long long start, int length) {
+        free_by_size[std::min(length, 9)].push({start, length});
+    };
+    for (const auto& free : frees) {
+        push_free(free.start, free.length);
     }
-    return blocks.size();
-}
 
-unsigned long long part1(const std::string& input) {
-    auto blocks = expandIntoBlocks(input);
-    while (std::find(blocks.begin(), blocks.end(), -1) != blocks.end()) {
-        blocks = moveOneBlock(blocks);
-    }
-    return checksum(blocks);
-}
+    unsigned long long sum = 0;
+    for (auto file = files.rbegin(); file != files.rend(); ++file) {
+        int best_size = 0;
+        for (int size = std::max(file->length, 1); size <= 9; size++) {
+            if (!free_by_size[size].empty() && free_by_size[size].top().first < file->start &&
+                (best_size == 0 || free_by_size[size].top() < free_by_size[best_size].top())) {
+                best_size = size;
+            }
+        }
 
-unsigned long long part2(const std::string& input) {
-    auto blocks = expandIntoBlocks(input);
-    
-    int max_value = -1;
-    for (int block : blocks) {
-        if (block > max_value) max_value = block;
-    }
-    
-    for (int value = max_value; value >= 0; value--) {
-        auto [start_idx, end_idx] = findContiguousFile(blocks, value);
-        size_t free_space_size = end_idx - start_idx + 1;
-        
-        std::vector<int> temp_blocks(blocks.begin(), blocks.begin() + start_idx);
-        size_t free_space_idx = findFirstContiguousFreeSpace(temp_blocks, free_space_size);
-        
-        if (free_space_idx == temp_blocks.size()) continue;
-        
-        blocks = changeFileToNone(blocks, value);
-        for (size_t i = 0; i < free_space_size; i++) {
-            blocks[free_space_idx + i] = value;
+        if (best_size != 0) {
+            auto [start, length] = free_by_size[best_size].top();
+            free_by_size[best_size].pop();
+            if (length > file->length) {
+                push_free(start + file->length, length - file->length);
+            }
+            file->start = start;
         }
+        sum += spanChecksum(file->id, file->start, file->length);
     }
-    
-    for (auto& block : blocks) {
-        if (block == -1) block = 0;
-    }
-    
-    return checksum(blocks);
+    return sum;
 }
 
 int main() {
     std::string test_input = readFile("test_input.txt");
+    std::string test_input_2 = "13047";
     std::string input = readFile("input.txt");
     std::cout << "part_1_test: " << part1(test_input) << std::endl;
     std::cout << "part_1:      " << part1(input) << std::endl;
     std::cout << "part_2_test: " << part2(test_input) << std::endl;
+    std::cout << "part_2_test_2: " << part2(test_input_2) << std::endl;
     std::cout << "part_2:      " << part2(input) << std::endl;
 
     return 0;
+}
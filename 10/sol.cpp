@@ -1,12 +1,15 @@
 /*
-The strategy here is simple:
-For part 1, we first find all the trail heads (0) in the matrix.
-Then for each trail head, we keep track of leads that might be able to reach the 9.
-We then step through the values from 1 to 9, finding new leads in the neighbours of the current leads.
-When we reach 9, we return the set of unique leads.
-Finally we sum up the size of the set of unique leads for each trail head.
-
-For part 2, we do the same thing, except we return the list of leads instead of the set of unique leads.
+The strategy here is to process the whole map once, layer by layer, from height 9 down to 0.
+Every 9 can reach itself, by exactly one trail.
+A cell of height h can reach every 9 its neighbours of height h + 1 can reach,
+and has as many trails as they have together.
+The reachable 9s are kept as bitsets, built tile by tile with a halo of 9 cells,
+so merging them is a word-wise OR and counting them a popcount.
+The tiles are independent and are spread across worker threads.
+
+For part 1, the score of a trail head (0) is the number of unique 9s it can reach.
+For part 2, the rating of a trail head is its number of trails.
+Both are summed over the trail heads.
 */
 
 
@@ -14,14 +17,16 @@ For part 2, we do the same thing, except we return the list of leads instead of
 #include <fstream>
 #include <vector>
 #include <string>
-#include <set>
+#include <array>
 #include <utility>
 #include <sstream>
 #include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <thread>
+#include <atomic>
 
 using Matrix = std::vector<std::vector<int>>;
-using Position = std::pair<int, int>;
-using PositionList = std::vector<Position>;
 
 Matrix inputToMatrix(const std::string& input) {
     Matrix matrix;
@@ -41,112 +46,186 @@ Matrix inputToMatrix(const std::string& input) {
     return matrix;
 }
 
-PositionList getPositionListOfTrailHeads(const Matrix& matrix) {
-    PositionList positions;
-    for (int i = 0; i < matrix.size(); i++) {
-        for (int j = 0; j < matrix[i].size(); j++) {
-            if (matrix[i][j] == 0) {
-                positions.push_back({i, j});
-            }
-        }
-    }
-    return positions;
-}
-
 std::string readFile(const std::string& filename) {
     std::ifstream file(filename);
     return std::string((std::istreambuf_iterator<char>(file)),
                        std::istreambuf_iterator<char>());
 }
 
-class Trail {
-public:
-    Trail(const Matrix& map, const Position& starting_pos) 
-        : map(map), starting_pos(starting_pos), current_value(0) {
-        current_heads_pos_list.push_back(starting_pos);
-    }
+struct TrailTotals {
+    long long scores = 0;
+    long long ratings = 0;
+};
 
-    PositionList find9Positions(bool part_1 = true) {
-        while (current_value < 9) {
-            nextStep();
-        }
-        if (part_1) {
-            std::set<Position> unique_positions(current_heads_pos_list.begin(), current_heads_pos_list.end());
-            return PositionList(unique_positions.begin(), unique_positions.end());
-        } else {
-            return current_heads_pos_list;
+// A trail never strays more than 9 steps from its head, so everything a head
+// can reach lies within this many cells of it.
+const int HALO = 9;
+const int TILE = 64;
+const int8_t OUTSIDE = -1;
+
+// Flat row-major copy of the map, the source every tile copies its region from.
+struct HeightMap {
+    int rows = 0;
+    int cols = 0;
+    std::vector<int8_t> heights;
+
+    HeightMap(const Matrix& matrix) : rows(matrix.size()), cols(matrix.empty() ? 0 : matrix[0].size()) {
+        heights.reserve(static_cast<size_t>(rows) * cols);
+        for (const auto& row : matrix) {
+            for (int j = 0; j < cols; j++) {
+                heights.push_back(j < static_cast<int>(row.size()) ? row[j] : OUTSIDE);
+            }
         }
     }
+};
 
-private:
-    void nextStep() {
-        current_value++;
-        PositionList new_pos_list;
-        
-        for (const auto& pos : current_heads_pos_list) {
-            for (const auto& neighbour_pos : getNeighbours(pos)) {
-                if (positionIsValuedAt(neighbour_pos, current_value)) {
-                    new_pos_list.push_back(neighbour_pos);
-                }
+// Per-thread scratch space, reused from one tile to the next.
+struct TileBuffers {
+    std::vector<int8_t> heights;
+    std::array<std::vector<int>, 10> layers;
+    std::vector<uint64_t> reach;
+    std::vector<long long> rating;
+};
+
+// Scores and ratings of the trail heads in rows [r0, r1) and columns
+// [c0, c1). The tile and a halo of HALO cells around it are copied into a
+// flat buffer with a one-cell OUTSIDE border, so the four neighbours of any
+// cell sit at fixed offsets and need no bounds checks. Neighbouring tiles
+// recompute each other's halo instead of exchanging it; cells near the edge
+// of the region may miss trails that leave it, but none that start at a head
+// inside the tile.
+//
+// The 9s in the region get local ids and every cell carries a bitset over
+// them plus a trail count. Walking heights 8 down to 0, a cell ORs in the
+// bitsets and adds up the counts of its neighbours one step higher; a head's
+// score is then a popcount and its rating its count.
+TrailTotals evaluateTile(const HeightMap& map, int r0, int r1, int c0, int c1, TileBuffers& buffers) {
+    int top = std::max(r0 - HALO, 0);
+    int left = std::max(c0 - HALO, 0);
+    int height_rows = std::min(r1 + HALO, map.rows) - top;
+    int width = std::min(c1 + HALO, map.cols) - left;
+    int stride = width + 2;
+    const std::array<int, 4> offsets = {1, -1, stride, -stride};
+
+    auto& heights = buffers.heights;
+    auto& layers = buffers.layers;
+    heights.assign(static_cast<size_t>(height_rows + 2) * stride, OUTSIDE);
+    for (auto& layer : layers) {
+        layer.clear();
+    }
+    for (int i = 0; i < height_rows; i++) {
+        const int8_t* source = &map.heights[static_cast<size_t>(top + i) * map.cols + left];
+        for (int j = 0; j < width; j++) {
+            int cell = (i + 1) * stride + j + 1;
+            heights[cell] = source[j];
+            if (source[j] >= 0 && source[j] <= 9) {
+                layers[source[j]].push_back(cell);
             }
         }
-        current_heads_pos_list = new_pos_list;
     }
 
-    PositionList getNeighbours(const Position& position) {
-        PositionList neighbours;
-        const std::vector<std::pair<int, int>> deltas = {{1, 0}, {-1, 0}, {0, 1}, {0, -1}};
-        
-        for (const auto& delta : deltas) {
-            int new_row = position.first + delta.first;
-            int new_col = position.second + delta.second;
-            
-            if (new_row >= 0 && new_row < map.size() && 
-                new_col >= 0 && new_col < map[0].size()) {
-                neighbours.push_back({new_row, new_col});
+    TrailTotals totals;
+    size_t words = (layers[9].size() + 63) / 64;
+    if (words == 0) {
+        return totals;
+    }
+    auto& reach = buffers.reach;
+    auto& rating = buffers.rating;
+    reach.assign(heights.size() * words, 0);
+    rating.assign(heights.size(), 0);
+    for (size_t id = 0; id < layers[9].size(); id++) {
+        reach[layers[9][id] * words + id / 64] |= uint64_t{1} << (id % 64);
+        rating[layers[9][id]] = 1;
+    }
+
+    for (int height = 8; height >= 0; height--) {
+        for (int cell : layers[height]) {
+            uint64_t* bits = &reach[cell * words];
+            for (int offset : offsets) {
+                int neighbour = cell + offset;
+                if (heights[neighbour] != height + 1) {
+                    continue;
+                }
+                const uint64_t* neighbour_bits = &reach[neighbour * words];
+                for (size_t w = 0; w < words; w++) {
+                    bits[w] |= neighbour_bits[w];
+                }
+                rating[cell] += rating[neighbour];
             }
         }
-        return neighbours;
     }
 
-    bool positionIsValuedAt(const Position& position, int desired_value) {
-        return map[position.first][position.second] == desired_value;
+    for (int cell : layers[0]) {
+        int i = top + cell / stride - 1;
+        int j = left + cell % stride - 1;
+        if (i < r0 || i >= r1 || j < c0 || j >= c1) {
+            continue;
+        }
+        for (size_t w = 0; w < words; w++) {
+            totals.scores += std::popcount(reach[cell * words + w]);
+        }
+        totals.ratings += rating[cell];
     }
+    return totals;
+}
 
-    Matrix map;
-    Position starting_pos;
-    int current_value;
-    PositionList current_heads_pos_list;
-};
-
-int solve(const std::string& input, bool part_1 = true) {
-    Matrix matrix = inputToMatrix(input);
-    PositionList position_list = getPositionListOfTrailHeads(matrix);
-    int total_score = 0;
+// Tiles are independent, so worker threads pull them from a shared counter
+// and the per-thread totals are summed at the end.
+TrailTotals evaluateTrails(const Matrix& matrix) {
+    HeightMap map(matrix);
+    std::vector<std::array<int, 4>> tiles;
+    for (int r0 = 0; r0 < map.rows; r0 += TILE) {
+        for (int c0 = 0; c0 < map.cols; c0 += TILE) {
+            tiles.push_back({r0, std::min(r0 + TILE, map.rows), c0, std::min(c0 + TILE, map.cols)});
+        }
+    }
 
-    for (const auto& position : position_list) {
-        Trail trail(matrix, position);
-        auto trail_9_positions = trail.find9Positions(part_1);
-        total_score += trail_9_positions.size();
+    int threads = std::clamp<int>(std::thread::hardware_concurrency(), 1, std::max<int>(tiles.size(), 1));
+    std::atomic<size_t> next_tile = 0;
+    std::vector<TrailTotals> partial(threads);
+    std::vector<std::thread> workers;
+
+    for (int t = 0; t < threads; t++) {
+        workers.emplace_back([&, t] {
+            TileBuffers buffers;
+            TrailTotals local;
+            for (size_t k = next_tile++; k < tiles.size(); k = next_tile++) {
+                auto [r0, r1, c0, c1] = tiles[k];
+                TrailTotals tile = evaluateTile(map, r0, r1, c0, c1, buffers);
+                local.scores += tile.scores;
+                local.ratings += tile.ratings;
+            }
+            partial[t] = local;
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
     }
-    return total_score;
-}
 
-int part1(const std::string& input) {
-    return solve(input, true);
+    TrailTotals totals;
+    for (const auto& tile : partial) {
+        totals.scores += tile.scores;
+        totals.ratings += tile.ratings;
+    }
+    return totals;
 }
 
-int part2(const std::string& input) {
-    return solve(input, false);
+// Both parts come out of the same layered pass over the map.
+TrailTotals solve(const std::string& input) {
+    return evaluateTrails(inputToMatrix(input));
 }
 
 int main() {
     std::string test_input = readFile("test_input.txt");
     std::string input = readFile("input.txt");
-    std::cout << "part_1_test: " << part1(test_input) << std::endl;
-    std::cout << "part_1:      " << part1(input) << std::endl;
-    std::cout << "part_2_test: " << part2(test_input) << std::endl;
-    std::cout << "part_2:      " << part2(input) << std::endl;
+
+    TrailTotals test_totals = solve(test_input);
+    TrailTotals totals = solve(input);
+
+    std::cout << "part_1_test: " << test_totals.scores << std::endl;
+    std::cout << "part_1:      " << totals.scores << std::endl;
+    std::cout << "part_2_test: " << test_totals.ratings << std::endl;
+    std::cout << "part_2:      " << totals.ratings << std::endl;
 
     return 0;
-}
\ No newline at end of file
+}
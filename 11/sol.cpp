@@ -1,14 +1,17 @@
 /*
 The strategy here is simple and fast:
 We store the number of stones as a dictionary, where the key is the stone and the value is the number of stones.
+The dictionary is a flat hash table; two of them are swapped every blink and cleared in place.
 We then iterate over the dictionary, and for each stone, we evaluate the new stones that can be created.
+Digits are split arithmetically, and each distinct stone's result is cached for every later blink.
 We then update the dictionary with the new stones.
 We repeat this process for the number of blinks.
 Finally, we sum up the number of stones in the dictionary.
 */
 #include <vector>
 #include <string>
-#include <map>
+#include <utility>
+#include <array>
 #include <sstream>
 #include <algorithm>
 #include <iostream>
@@ -30,61 +33,162 @@ std::vector<long long> inputToList(const std::string& input) {
     return result;
 }
 
-std::map<long long, long long> listToDict(const std::vector<long long>& stoneList) {
-    std::map<long long, long long> result;
-    for (long long element : stoneList) {
-        result[element]++;
+// Flat open-addressing table keyed by stone, with linear probing over a
+// power-of-two capacity. The occupied slots are also listed, so iterating
+// and clearing only touch live entries and never free the storage.
+template<typename Value>
+class StoneTable {
+public:
+    StoneTable() : keys(16, EMPTY), values(16) {}
+
+    // Returns the stone's value, inserting a default one if it is missing.
+    Value& operator[](long long stone) {
+        if ((occupied.size() + 1) * 2 > keys.size()) {
+            grow();
+        }
+        size_t slot = find(stone);
+        if (keys[slot] == EMPTY) {
+            keys[slot] = stone;
+            occupied.push_back(slot);
+        }
+        return values[slot];
     }
-    return result;
+
+    const Value* get(long long stone) const {
+        size_t slot = find(stone);
+        return keys[slot] == EMPTY ? nullptr : &values[slot];
+    }
+
+    void clear() {
+        for (size_t slot : occupied) {
+            keys[slot] = EMPTY;
+            values[slot] = Value{};
+        }
+        occupied.clear();
+    }
+
+    template<typename F>
+    void forEach(F f) const {
+        for (size_t slot : occupied) {
+            f(keys[slot], values[slot]);
+        }
+    }
+
+private:
+    static constexpr long long EMPTY = -1;
+
+    std::vector<long long> keys;
+    std::vector<Value> values;
+    std::vector<size_t> occupied;
+
+    size_t find(long long stone) const {
+        size_t mask = keys.size() - 1;
+        size_t slot = (static_cast<unsigned long long>(stone) * 0x9E3779B97F4A7C15ULL) >> 17 & mask;
+        while (keys[slot] != EMPTY && keys[slot] != stone) {
+            slot = (slot + 1) & mask;
+        }
+        return slot;
+    }
+
+    void grow() {
+        std::vector<long long> oldKeys = std::exchange(keys, std::vector<long long>(keys.size() * 2, EMPTY));
+        std::vector<Value> oldValues = std::exchange(values, std::vector<Value>(values.size() * 2));
+        std::vector<size_t> oldOccupied = std::exchange(occupied, {});
+
+        for (size_t slot : oldOccupied) {
+            size_t newSlot = find(oldKeys[slot]);
+            keys[newSlot] = oldKeys[slot];
+            values[newSlot] = oldValues[slot];
+            occupied.push_back(newSlot);
+        }
+    }
+};
+
+// The stones a stone turns into after one blink: `first`, and `second` too
+// when it splits.
+struct Transition {
+    long long first = 0;
+    long long second = 0;
+    bool splits = false;
+};
+
+using StoneCounts = StoneTable<long long>;
+using TransitionCache = StoneTable<Transition>;
+
+// POW10[i] == 10^i, for every power that fits in a long long.
+constexpr std::array<long long, 19> POW10 = [] {
+    std::array<long long, 19> pow10{};
+    pow10[0] = 1;
+    for (size_t i = 1; i < pow10.size(); i++) {
+        pow10[i] = pow10[i - 1] * 10;
+    }
+    return pow10;
+}();
+
+int countDigits(long long element) {
+    return std::upper_bound(POW10.begin() + 1, POW10.end(), element) - POW10.begin();
 }
 
-std::vector<std::pair<long long, long long>> evalveDict(long long element) {
+Transition evolve(long long element) {
     if (element == 0) {
-        return {{1, 1}};
+        return {1, 0, false};
     }
     
-    std::string numStr = std::to_string(element);
-    if (numStr.length() % 2 == 0) {
-        int mid = numStr.length() / 2;
-        long long firstHalf = std::stoll(numStr.substr(0, mid));
-        long long secondHalf = std::stoll(numStr.substr(mid));
-        return {{firstHalf, 1}, {secondHalf, 1}};
+    int digits = countDigits(element);
+    if (digits % 2 == 0) {
+        long long half = POW10[digits / 2];
+        return {element / half, element % half, true};
     } else {
-        return {{2024LL * element, 1}};
+        return {2024LL * element, 0, false};
+    }
+}
+
+// Looks the transition up in the cache, working it out on first sight only.
+// After a few dozen blinks almost every stone value is a repeat.
+Transition evolveCached(long long element, TransitionCache& cache) {
+    if (const Transition* cached = cache.get(element)) {
+        return *cached;
     }
+    Transition transition = evolve(element);
+    cache[element] = transition;
+    return transition;
 }
 
-long long solve(const std::string& input, int nBlinks) {
-    std::vector<long long> stones = inputToList(input);
-    std::map<long long, long long> stonesDict = listToDict(stones);
+long long solve(const std::string& input, int nBlinks, TransitionCache& cache) {
+    StoneCounts stonesDict;
+    StoneCounts newStonesDict;
+    for (long long element : inputToList(input)) {
+        stonesDict[element] += 1;
+    }
     
     for (int i = 0; i < nBlinks; i++) {
-        std::map<long long, long long> newStonesDict;
+        newStonesDict.clear();
         
-        for (const auto& pair : stonesDict) {
-            auto evalvedStonesList = evalveDict(pair.first);
-            
-            for (const auto& evolved : evalvedStonesList) {
-                newStonesDict[evolved.first] += evolved.second * pair.second;
+        stonesDict.forEach([&](long long stone, long long count) {
+            Transition transition = evolveCached(stone, cache);
+            newStonesDict[transition.first] += count;
+            if (transition.splits) {
+                newStonesDict[transition.second] += count;
             }
-        }
+        });
         
-        stonesDict = newStonesDict;
+        std::swap(stonesDict, newStonesDict);
     }
     
     long long sum = 0;
-    for (const auto& pair : stonesDict) {
-        sum += pair.second;
-    }
+    stonesDict.forEach([&](long long, long long count) {
+        sum += count;
+    });
     return sum;
 }
 
 int main() {
     std::string test_input = readFile("test_input.txt");
     std::string input = readFile("input.txt");
-    std::cout << "part_1_test: " << solve(test_input, 25) << std::endl;
-    std::cout << "part_1:      " << solve(input, 25) << std::endl;
-    std::cout << "part_2:      " << solve(input, 75) << std::endl;
+    TransitionCache cache;
+    std::cout << "part_1_test: " << solve(test_input, 25, cache) << std::endl;
+    std::cout << "part_1:      " << solve(input, 25, cache) << std::endl;
+    std::cout << "part_2:      " << solve(input, 75, cache) << std::endl;
 
     return 0;
 }
\ No newline at end of file